@@ -0,0 +1,28 @@
+#ifndef __AgentFilter_h__
+#define __AgentFilter_h__
+
+#include "HouseholdPums.h"
+#include "PersonPums.h"
+
+/**
+*	@brief Compile-time filter policy handed to Metro::createAgents by the models.
+*	Models declare a nested "Filter" type exposing static household and person
+*	predicates. Only households/persons accepted by the filter are materialized
+*	and handed over to the model, while household and person counts used for the
+*	goodness-of-fit check are still taken over every drawn record.
+*	AcceptAll is the default policy and can be used as base of a model's filter.
+*/
+struct AcceptAll
+{
+	static bool acceptHousehold(const HouseholdPums *)
+	{
+		return true;
+	}
+
+	static bool acceptPerson(const PersonPums *)
+	{
+		return true;
+	}
+};
+
+#endif __AgentFilter_h__
@@ -0,0 +1,80 @@
+#include "AgentSet.h"
+
+AgentSet::AgentSet()
+{
+}
+
+AgentSet::~AgentSet()
+{
+}
+
+/**
+*	@brief Empties the set and sizes it for agent IDs 0 to num-1
+*	@param num is number of agents
+*	@return void
+*/
+void AgentSet::resize(size_t num)
+{
+	words.assign((num+63)/64, 0);
+}
+
+void AgentSet::clear()
+{
+	std::vector<uint64_t>().swap(words);
+}
+
+/**
+*	@brief Removes all agents of another set of the same size
+*	@return void
+*/
+void AgentSet::subtract(const AgentSet &other)
+{
+	for(size_t i = 0; i < words.size(); ++i)
+		words[i] &= ~other.words[i];
+}
+
+/**
+*	@return number of agents in the set
+*/
+size_t AgentSet::size() const
+{
+	size_t count = 0;
+	for(size_t i = 0; i < words.size(); ++i)
+		count += std::bitset<64>(words[i]).count();
+
+	return count;
+}
+
+/**
+*	@brief Iterates the set: for(int id = set.next(0); id >= 0; id = set.next(id+1))
+*	@param from is lowest agent ID to look at
+*	@return lowest agent ID of the set not below from, or -1
+*/
+int AgentSet::next(int from) const
+{
+	size_t w = (size_t)from >> 6;
+	if(from < 0 || w >= words.size())
+		return -1;
+
+	uint64_t bits = words[w] & (~(uint64_t)0 << (from & 63));
+	while(bits == 0)
+	{
+		if(++w >= words.size())
+			return -1;
+
+		bits = words[w];
+	}
+
+	return (int)(w*64)+lowestBit(bits);
+}
+
+int AgentSet::lowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward64(&idx, bits);
+	return (int)idx;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef __AgentSet_h__
+#define __AgentSet_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitset>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+*	@brief Set of agents as a dense bitset indexed by integer agent ID. Membership
+*	is one bit test, the size is a popcount of the words and iteration scans the 
+*	words for set bits, so whole pools are combined word by word.
+*/
+class AgentSet
+{
+public:
+	AgentSet();
+	virtual ~AgentSet();
+
+	void resize(size_t);
+	void clear();
+
+	void insert(int id)
+	{
+		words[id >> 6] |= (uint64_t)1 << (id & 63);
+	}
+
+	bool contains(int id) const
+	{
+		return (words[id >> 6] >> (id & 63)) & 1;
+	}
+
+	void subtract(const AgentSet &);
+
+	size_t size() const;
+	int next(int) const;
+
+private:
+	static int lowestBit(uint64_t);
+
+	std::vector<uint64_t> words;
+};
+
+#endif __AgentSet_h__
@@ -0,0 +1,142 @@
+#include "AgentSink.h"
+#include "Counter.h"
+#include "Parameters.h"
+
+#include <cstring>
+#include <algorithm>
+
+CountSink::CountSink(Counter *c) : counter(c)
+{
+}
+
+CountSink::~CountSink()
+{
+}
+
+void CountSink::begin()
+{
+	counter->initialize();
+}
+
+void CountSink::onHousehold(const std::string &hhType, const HouseholdPums *, int, int weight)
+{
+	counter->addHouseholdCount(hhType, weight);
+}
+
+/**
+*	@brief Counts persons of a drawn household by the person types of the
+*	IPF/IPU constraints (sex-age-origin and sex-age-origin-education for adults),
+*	by the person pool indices precomputed per PUMS record
+*	@param persons is first person of the household
+*	@param num is number of persons in the household
+*	@param weight is number of persons represented by each record
+*	@return void
+*/
+void CountSink::onPersonBatch(const PersonPums *persons, size_t num, int, int weight)
+{
+	for(size_t i = 0; i < num; ++i)
+	{
+		counter->addPersonCountAt(persons[i].getPersonType(), weight);
+		counter->addPersonCountAt(persons[i].getEduPersonType(), weight);
+	}
+}
+
+Counter * CountSink::getCounter() const
+{
+	return counter;
+}
+
+/**
+*	@param c is counter of the goodness-of-fit check
+*	@param fname is path of the records file; its directory (e.g. agents/) is created if missing
+*/
+BinaryFileSink::BinaryFileSink(Counter *c, const std::string &fname) : CountSink(c), fileName(fname), curPuma(0), num_records(0)
+{
+	size_t sep = fileName.find_last_of('/');
+	if(sep != std::string::npos)
+		Parameters::createDirectory(fileName.substr(0, sep+1));
+
+	outFile.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!outFile.is_open())
+	{
+		std::cout << "Error: Cannot create " << fileName << "!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+}
+
+BinaryFileSink::~BinaryFileSink()
+{
+	if(outFile.is_open())
+		outFile.close();
+}
+
+void BinaryFileSink::onHousehold(const std::string &hhType, const HouseholdPums *hh, int hhId, int weight)
+{
+	CountSink::onHousehold(hhType, hh, hhId, weight);
+	curPuma = hh->getPUMA();
+}
+
+void BinaryFileSink::onPersonBatch(const PersonPums *persons, size_t num, int hhId, int weight)
+{
+	CountSink::onPersonBatch(persons, num, hhId, weight);
+
+	for(size_t i = 0; i < num; ++i)
+	{
+		put<int32_t>(hhId);
+		put<int32_t>(curPuma);
+		put<double>(persons[i].getPUMSID());
+		put<int16_t>(persons[i].getAge());
+		put<int16_t>(persons[i].getSex());
+		put<int16_t>(persons[i].getOrigin());
+		put<int16_t>(persons[i].getEducation());
+		put<int32_t>(weight);
+	}
+
+	num_records += num;
+}
+
+void BinaryFileSink::flush(int)
+{
+	outFile.flush();
+}
+
+/**
+*	@brief Rejected draw attempt: truncates records written so far
+*	@return void
+*/
+void BinaryFileSink::discard()
+{
+	outFile.close();
+	outFile.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	num_records = 0;
+}
+
+void BinaryFileSink::finish()
+{
+	outFile.close();
+	std::cout << "Agent records written to " << fileName << ": " << num_records << std::endl;
+}
+
+size_t BinaryFileSink::getRecordCount() const
+{
+	return num_records;
+}
+
+/**
+*	@brief Writes a value in little-endian byte order (bytes are swapped on
+*	big-endian hosts)
+*	@param val is value
+*	@return void
+*/
+template <class V>
+void BinaryFileSink::put(V val)
+{
+	static const uint16_t byte_order = 1;
+	char bytes[sizeof(V)];
+	std::memcpy(bytes, &val, sizeof(V));
+
+	if(*reinterpret_cast<const char*>(&byte_order) == 0)
+		std::reverse(bytes, bytes+sizeof(V));
+
+	outFile.write(bytes, sizeof(V));
+}
@@ -0,0 +1,198 @@
+#ifndef __AgentSink_h__
+#define __AgentSink_h__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "HouseholdPums.h"
+#include "PersonPums.h"
+
+class Counter;
+
+/**
+*	@brief Sinks receive households and persons drawn by Metro::generateAgents. A
+*	sink is a compile-time policy; Metro instantiates its draw loops on the sink
+*	type and calls the hooks: begin() at the start of a draw attempt, reserve()
+*	with the number of persons about to be emitted, onHousehold() for every drawn
+*	household, onPersonBatch() with the persons of that household as a contiguous
+*	span, flush() when a PUMA is complete (streaming mode), discard() when a draw
+*	attempt is rejected by the goodness-of-fit check and finish() once all
+*	households have been emitted. getCounter() returns the counter used for the
+*	goodness-of-fit check.
+*	CountSink only counts drawn records; the other sinks extend it.
+*/
+class CountSink
+{
+public:
+	CountSink(Counter *);
+	virtual ~CountSink();
+
+	void begin();
+	void reserve(size_t) {}
+	void onHousehold(const std::string &, const HouseholdPums *, int, int);
+	void onPersonBatch(const PersonPums *, size_t, int, int);
+	void flush(int) {}
+	void discard() {}
+	void finish() {}
+
+	Counter *getCounter() const;
+
+protected:
+	Counter *counter;
+};
+
+/**
+*	@brief Hands drawn records over to a simulation model. Records are screened
+*	by the model's compile-time filter (T::Filter) before they are added.
+*/
+template <class T>
+class ModelSink : public CountSink
+{
+public:
+	typedef typename T::Filter Filter;
+
+	ModelSink(T *m) : CountSink(m->getCounter()), model(m), hhAccepted(false)
+	{
+	}
+
+	void reserve(size_t num_persons)
+	{
+		model->setSize((int)num_persons);
+	}
+
+	void onHousehold(const std::string &hhType, const HouseholdPums *hh, int hhId, int weight)
+	{
+		CountSink::onHousehold(hhType, hh, hhId, weight);
+
+		hhAccepted = Filter::acceptHousehold(hh);
+		if(hhAccepted)
+			model->addHousehold(hh, hhId);
+	}
+
+	void onPersonBatch(const PersonPums *persons, size_t num, int hhId, int weight)
+	{
+		CountSink::onPersonBatch(persons, num, hhId, weight);
+
+		if(!hhAccepted)
+			return;
+
+		for(size_t i = 0; i < num; ++i)
+		{
+			if(Filter::acceptPerson(&persons[i]))
+				model->addAgent(&persons[i], weight);
+		}
+	}
+
+	void flush(int puma)
+	{
+		model->flushPuma(puma);
+	}
+
+	void discard()
+	{
+		model->clearList();
+	}
+
+private:
+	T *model;
+	bool hhAccepted;
+};
+
+/**
+*	@brief Hands every drawn record to two sinks, so that two simulation models
+*	consume one draw. The goodness-of-fit check uses the counter of the first sink.
+*/
+template <class First, class Second>
+class FanOutSink
+{
+public:
+	FanOutSink(First *f, Second *s) : first(f), second(s)
+	{
+	}
+
+	void begin()
+	{
+		first->begin();
+		second->begin();
+	}
+
+	void reserve(size_t num_persons)
+	{
+		first->reserve(num_persons);
+		second->reserve(num_persons);
+	}
+
+	void onHousehold(const std::string &hhType, const HouseholdPums *hh, int hhId, int weight)
+	{
+		first->onHousehold(hhType, hh, hhId, weight);
+		second->onHousehold(hhType, hh, hhId, weight);
+	}
+
+	void onPersonBatch(const PersonPums *persons, size_t num, int hhId, int weight)
+	{
+		first->onPersonBatch(persons, num, hhId, weight);
+		second->onPersonBatch(persons, num, hhId, weight);
+	}
+
+	void flush(int puma)
+	{
+		first->flush(puma);
+		second->flush(puma);
+	}
+
+	void discard()
+	{
+		first->discard();
+		second->discard();
+	}
+
+	void finish()
+	{
+		first->finish();
+		second->finish();
+	}
+
+	Counter *getCounter() const
+	{
+		return first->getCounter();
+	}
+
+private:
+	First *first;
+	Second *second;
+};
+
+/**
+*	@brief Writes drawn persons as fixed-size little-endian binary records:
+*	household id (int32), PUMA (int32), PUMS serial number (double), age, sex,
+*	origin and education (int16 each), weight (int32).
+*/
+class BinaryFileSink : public CountSink
+{
+public:
+	BinaryFileSink(Counter *, const std::string &);
+	virtual ~BinaryFileSink();
+
+	void onHousehold(const std::string &, const HouseholdPums *, int, int);
+	void onPersonBatch(const PersonPums *, size_t, int, int);
+	void flush(int);
+	void discard();
+	void finish();
+
+	size_t getRecordCount() const;
+
+private:
+	template <class V>
+	void put(V);
+
+	std::string fileName;
+	std::ofstream outFile;
+
+	int curPuma;
+	size_t num_records;
+};
+
+#endif __AgentSink_h__
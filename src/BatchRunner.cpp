@@ -0,0 +1,284 @@
+#include "BatchRunner.h"
+#include "Metro.h"
+#include "CardioModel.h"
+#include "ViolenceModel.h"
+#include "WorkStealingPool.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+BatchRunner::BatchRunner() : journalFile(NULL)
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+	if(journalFile != NULL)
+		fclose(journalFile);
+}
+
+/**
+*	@brief Runs all jobs of the manifest in manifest order, skipping (job, MSA)
+*	pairs already recorded in the journal
+*	@param manifestFile is path of the manifest
+*	@param journalFile is path of the completion journal
+*	@return void
+*/
+void BatchRunner::run(const std::string &manifestFile, const std::string &journalPath)
+{
+	if(parameters == NULL)
+	{
+		std::cout << "Error: Parameters are not initialized!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	readJournal(journalPath);
+	readManifest(manifestFile);
+
+	journalFile = fopen(journalPath.c_str(), "a");
+	if(journalFile == NULL)
+	{
+		std::cout << "Error: Cannot open journal " << journalPath << "!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	for(size_t i = 0; i < jobs.size(); ++i)
+	{
+		const Job &job = jobs[i];
+		std::cout << "Job " << job.name << ": " << job.metros.size() << " MSAs to run" << std::endl;
+
+		if(job.metros.empty())
+			continue;
+
+		if(job.simType == MASS_VIOLENCE)
+			runViolenceJob(job, i);
+		else
+			runCardioJob(job, i);
+	}
+
+	fclose(journalFile);
+	journalFile = NULL;
+}
+
+void BatchRunner::runCardioJob(const Job &job, size_t jobIndex)
+{
+	const RunParams *runParam = job.param->getRunParam();
+	WorkStealingPool pool(runParam->num_threads, runParam->mem_budget);
+
+	for(auto metro = job.metros.begin(); metro != job.metros.end(); ++metro)
+	{
+		Metro *curMSA = *metro;
+		pool.submit([this, &job, curMSA, jobIndex]()
+		{
+			CardioModel model(job.param);
+			model.runMetro(curMSA);
+			curMSA->writeGofLog();
+
+			releaseMetro(curMSA, jobIndex);
+			record(job.name, curMSA->getGeoID());
+		}, CardioModel::getMemoryEstimate(curMSA));
+	}
+	pool.run();
+}
+
+void BatchRunner::runViolenceJob(const Job &job, size_t jobIndex)
+{
+	Metro *metro = job.metros.front();
+
+	ViolenceModel model(job.param);
+	model.run(metro);
+
+	releaseMetro(metro, jobIndex);
+	record(job.name, metro->getGeoID());
+}
+
+void BatchRunner::releaseMetro(Metro *metro, size_t jobIndex)
+{
+	if(lastUse.at(metro->getGeoID()) == jobIndex)
+		metro->releaseIPU();
+}
+
+void BatchRunner::readManifest(const std::string &fileName)
+{
+	std::ifstream manifest(fileName);
+	if(!manifest.is_open())
+	{
+		std::cout << "Error: Cannot open manifest " << fileName << "!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	int baseSimType = parameters->getSimType();
+
+	std::string line;
+	int lineNum = 0;
+	while(std::getline(manifest, line))
+	{
+		lineNum++;
+		size_t first = line.find_first_not_of(" \t\r");
+		if(first == std::string::npos || line[first] == '#')
+			continue;
+
+		parseJob(line, lineNum);
+	}
+
+	parameters->setSimType(baseSimType);
+
+	for(size_t i = 0; i < jobs.size(); ++i)
+	{
+		for(auto metro = jobs[i].metros.begin(); metro != jobs[i].metros.end(); ++metro)
+			lastUse[(*metro)->getGeoID()] = i;
+	}
+}
+
+/**
+*	@brief Parses a manifest line into a job with its own copy of parameters
+*	@param line is manifest line
+*	@param lineNum is line number (for error messages)
+*	@return void
+*/
+void BatchRunner::parseJob(const std::string &line, int lineNum)
+{
+	Job job;
+	job.simType = parameters->getSimType();
+
+	Parameters::MapStr options;
+	std::map<std::string, double> mvsInputs;
+	std::string outDir;
+
+	std::istringstream fields(line);
+	std::string field;
+	while(fields >> field)
+	{
+		size_t eq = field.find('=');
+		if(eq == std::string::npos)
+		{
+			std::cout << "Error: Malformed field " << field << " in line " << lineNum << " of manifest!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		std::string key = field.substr(0, eq), val = field.substr(eq+1);
+		if(key == "job")
+			job.name = val;
+		else if(key == "model")
+		{
+			if(val == "eet")
+				job.simType = EQUITY_EFFICIENCY;
+			else if(val == "mvs")
+				job.simType = MASS_VIOLENCE;
+			else
+			{
+				std::cout << "Error: Invalid model " << val << " in line " << lineNum << " of manifest!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(key == "out")
+		{
+			if(val.empty())
+			{
+				std::cout << "Error: Empty output directory in line " << lineNum << " of manifest!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+			outDir = (val.back() == '/') ? val : val+"/";
+		}
+		else if(key.compare(0, 4, "mvs.") == 0)
+			mvsInputs[key.substr(4)] = std::atof(val.c_str());
+		else if(key == "msa" || key == "seed" || key == "threads" || key == "memory-budget")
+			options[key] = val;
+		else
+		{
+			std::cout << "Error: Option " << key << " cannot be set per job (line " << lineNum << " of manifest)!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+	}
+
+	if(job.name.empty() || job.name.find(',') != std::string::npos)
+	{
+		std::cout << "Error: Missing or invalid job name in line " << lineNum << " of manifest!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	for(auto other = jobs.begin(); other != jobs.end(); ++other)
+	{
+		if(other->name == job.name)
+		{
+			std::cout << "Error: Duplicate job " << job.name << " in line " << lineNum << " of manifest!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+	}
+
+	//model inputs are read once into the shared parameters and copied to the job
+	parameters->setSimType(job.simType);
+	job.param = std::make_shared<Parameters>(*parameters);
+	job.param->setRunParams(&options);
+	if(!outDir.empty())
+		job.param->setOutputDir(outDir);
+
+	for(auto input = mvsInputs.begin(); input != mvsInputs.end(); ++input)
+	{
+		if(job.simType != MASS_VIOLENCE || !job.param->setViolenceParam(input->first, input->second))
+		{
+			std::cout << "Error: Invalid Mass Violence input mvs." << input->first << " in line " << lineNum << " of manifest!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+	}
+
+	std::vector<Metro*> metros = getSelectedMetros(job.param->getRunParam()->msa_list, (job.simType == MASS_VIOLENCE) ? DEFAULT_MSA : "");
+	if(job.simType == MASS_VIOLENCE && metros.size() != 1)
+	{
+		std::cout << "Error: Mass Violence job " << job.name << " must select a single MSA!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	for(auto metro = metros.begin(); metro != metros.end(); ++metro)
+	{
+		if(!isDone(job.name, (*metro)->getGeoID()))
+			job.metros.push_back(*metro);
+	}
+
+	jobs.push_back(job);
+}
+
+void BatchRunner::readJournal(const std::string &fileName)
+{
+	std::ifstream journalIn(fileName);
+	if(!journalIn.is_open())
+		return;
+
+	std::string line;
+	while(std::getline(journalIn, line))
+	{
+		//a partially written last entry is ignored
+		size_t sep = line.find(',');
+		if(sep == std::string::npos || line.size() <= sep+1)
+			continue;
+
+		journal.insert(std::make_pair(line.substr(0, sep), line.substr(sep+1)));
+	}
+
+	std::cout << "Journal " << fileName << ": " << journal.size() << " completed entries" << std::endl;
+}
+
+/**
+*	@brief Appends a completed (job, MSA) entry to the journal and syncs it to disk
+*	@param job is job name
+*	@param geoID is MSA
+*	@return void
+*/
+void BatchRunner::record(const std::string &job, const std::string &geoID)
+{
+	std::lock_guard<std::mutex> lock(journalLock);
+
+	fprintf(journalFile, "%s,%s\n", job.c_str(), geoID.c_str());
+	fflush(journalFile);
+#ifndef _WIN32
+	fsync(fileno(journalFile));
+#endif
+
+	journal.insert(std::make_pair(job, geoID));
+}
+
+bool BatchRunner::isDone(const std::string &job, const std::string &geoID) const
+{
+	return journal.count(std::make_pair(job, geoID)) > 0;
+}
@@ -0,0 +1,66 @@
+#ifndef __BatchRunner_h__
+#define __BatchRunner_h__
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+
+#include "PopBrewer.h"
+
+class Metro;
+
+/**
+*	@brief Runs the jobs of a manifest file in one process. Parameters, ACS 
+*	marginals and the IPU solution of an MSA are shared by all jobs; the IPU 
+*	solution is released after the last job using the MSA. One job per line:
+*		job=<name> [model=eet|mvs] [msa=all|ID[,ID...]] [seed=S] [out=DIR]
+*		[threads=N] [memory-budget=MB] [mvs.<input>=<value> ...]
+*	where mvs.<input> overrides a variable of mass_violence/mass_violence_input.csv.
+*	Blank lines and lines starting with '#' are ignored.
+*	Each completed (job, MSA) is appended to the journal and synced to disk, so 
+*	a restarted run with the same journal skips finished work.
+*/
+class BatchRunner : public PopBrewer
+{
+public:
+	BatchRunner();
+	virtual ~BatchRunner();
+
+	void run(const std::string &, const std::string &);
+
+private:
+	struct Job
+	{
+		std::string name;
+		int simType;
+		std::shared_ptr<Parameters> param;
+		std::vector<Metro*> metros; //MSAs not yet in the journal
+	};
+
+	void readManifest(const std::string &);
+	void parseJob(const std::string &, int);
+
+	void readJournal(const std::string &);
+	void record(const std::string &, const std::string &);
+	bool isDone(const std::string &, const std::string &) const;
+
+	void runCardioJob(const Job &, size_t);
+	void runViolenceJob(const Job &, size_t);
+	void releaseMetro(Metro *, size_t);
+
+	std::vector<Job> jobs;
+	std::map<std::string, size_t> lastUse; //MSA -> index of last job using it
+
+	std::set<std::pair<std::string, std::string>> journal;
+	FILE *journalFile;
+	std::mutex journalLock;
+};
+
+#endif __BatchRunner_h__
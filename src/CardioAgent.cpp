@@ -23,6 +23,7 @@ CardioAgent::CardioAgent(const PersonPums *person, std::shared_ptr<Parameters> p
 	this->nhanes_edu = (education <= ACS::Education::High_School) ? NHANES::Edu::HS_or_less : NHANES::Edu::some_coll_;
 
 	this->rfStrata = -1;
+	this->weight = 1;
 
 	setNHANESAgeCat();
 }
@@ -64,6 +65,11 @@ void CardioAgent::setRiskFactors(Random &random, short int rfs)
 	setSmokingStatus();
 }
 
+void CardioAgent::setWeight(int w)
+{
+	this->weight = w;
+}
+
 void CardioAgent::setTotalCholesterol(Random & random)
 {
 	const PairMap *tcholsMap = parameters->getRiskFactorMap(NHANES::RiskFac::totalChols);
@@ -130,6 +136,11 @@ short int CardioAgent::getRiskStrata() const
 	return rfStrata;
 }
 
+int CardioAgent::getWeight() const
+{
+	return weight;
+}
+
 std::string CardioAgent::getAgentType() const
 {
 	std::string agentType = std::to_string(rfStrata)+std::to_string(nhanes_org)
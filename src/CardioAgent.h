@@ -38,11 +38,13 @@ public:
 	void setNHANESOrigin(short int);
 	void setNHANESEduCat(short int);
 	void setRiskFactors(Random &, short int);
+	void setWeight(int);
 
 	short int getNHANESAgeCat() const;
 	short int getNHANESOrigin() const;
 	short int getNHANESEduCat() const;
 	short int getRiskStrata() const;
+	int getWeight() const;
 	std::string getAgentType() const;
 	RiskFactors getRiskChart() const;
 
@@ -62,6 +64,7 @@ private:
 	short int nhanes_edu;
 
 	short int rfStrata;
+	int weight;
 
 	RiskFactors chart;
 };
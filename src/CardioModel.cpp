@@ -6,49 +6,169 @@
 #include "Random.h"
 #include "Parameters.h"
 #include "Counter.h"
+#include "WorkStealingPool.h"
+#include "MetroPipeline.h"
 
-CardioModel::CardioModel() 
+CardioModel::CardioModel() : count(NULL)
 {
 	
 }
 
+CardioModel::CardioModel(std::shared_ptr<Parameters> param) : PopBrewer(param), count(NULL)
+{
+
+}
+
 CardioModel::~CardioModel()
 {
 	delete count;
 }
 
+/**
+*	@brief Runs the CVD model on every selected MSA ("--msa", all MSAs by default).
+*	MSAs run concurrently on a work-stealing pool, largest population first, with 
+*	at most "--threads" MSAs at a time and within "--memory-budget". Each MSA gets
+*	its own model instance and counter and writes its own output files; fit logs 
+*	are written in MSA order once all MSAs are done, so the files are the same as
+*	those of a serial run. With "--shard=i/N" only the MSAs of shard i are run.
+*	With "--pipeline" MSAs instead run one after another through a pipeline that
+*	overlaps PUMS import, IPU and drawing of consecutive MSAs (see MetroPipeline).
+*	@param none
+*	@return void
+*/
 void CardioModel::start()
 {
-	if(parameters != NULL)
-		count = new Counter(parameters);
-	else{
+	if(parameters == NULL)
+	{
 		std::cout << "Error: Parameters are not initialized!" << std::endl;
 		exit(EXIT_SUCCESS);
 	}
 
-	
-	Metro *curMSA = &metroAreas.at("10180");
-	createPopulation(curMSA);
-	setRiskFactors();
-	clearList();
-	//curMSA->createPopulation(this);
+	std::vector<Metro*> metros = getShardMetros(getSelectedMetros(""));
+	const RunParams *runParam = parameters->getRunParam();
 
-	/*for(auto metro = metroAreas.begin(); metro != metroAreas.end(); ++metro)
+	//replicate populations are written to file; the model is not run on them
+	if(runParam->num_replicates > 1)
 	{
-		createPopulation(&metro->second);
+		for(auto metro = metros.begin(); metro != metros.end(); ++metro)
+		{
+			(*metro)->generateReplicates(runParam->num_replicates);
+			(*metro)->releaseIPU();
+		}
+
+		for(auto metro = metroAreas.begin(); metro != metroAreas.end(); ++metro)
+			metro->second.writeGofLog();
+		return;
+	}
+
+	if(runParam->pipeline_depth > 0)
+	{
+		std::shared_ptr<Parameters> param = parameters;
+
+		MetroPipeline pipeline(runParam->pipeline_depth);
+		pipeline.run(metros, [param](Metro *curMSA)
+		{
+			CardioModel model(param);
+			model.runMetro(curMSA);
+			curMSA->releaseIPU();
+		});
+		pipeline.printStats();
+
+		for(auto metro = metroAreas.begin(); metro != metroAreas.end(); ++metro)
+			metro->second.writeGofLog();
+		return;
+	}
+
+	WorkStealingPool pool(runParam->num_threads, runParam->mem_budget);
+	for(auto metro = metros.begin(); metro != metros.end(); ++metro)
+	{
+		Metro *curMSA = *metro;
+		std::shared_ptr<Parameters> param = parameters;
+
+		pool.submit([curMSA, param]()
+		{
+			CardioModel model(param);
+			model.runMetro(curMSA);
+			curMSA->releaseIPU();
+		}, getMemoryEstimate(curMSA));
+	}
+
+	std::cout << "Running " << metros.size() << " MSAs on " << pool.getNumWorkers() << " threads...\n" << std::endl;
+	pool.run();
+
+	for(auto metro = metroAreas.begin(); metro != metroAreas.end(); ++metro)
+		metro->second.writeGofLog();
+}
+
+/**
+*	@brief Creates population of an MSA, assigns risk factors and writes outputs.
+*	Households are drawn with the random stream of the run seed, or with the 
+*	given stream. IPU solution of the MSA is kept for later runs.
+*	@param metro is MSA
+*	@param random is random number stream of the draw
+*	@return void
+*/
+void CardioModel::runMetro(Metro *metro)
+{
+	Random random(parameters->getRunParam()->seed, metro->getGeoID(), 0, RNG_PHASE_DRAW);
+	runMetro(metro, random);
+}
+
+void CardioModel::runMetro(Metro *metro, Random &random)
+{
+	prepareMetro(metro, random);
+	createPopulation(metro, random);
+	finishMetro(metro);
+}
+
+/**
+*	@brief Prepares the model for the population of an MSA, before households are
+*	drawn (by runMetro() or by a draw shared with other models)
+*	@param random is random number stream of the draw, at its start
+*	@return void
+*/
+void CardioModel::prepareMetro(Metro *, Random &random)
+{
+	count = new Counter(parameters);
+	riskStream = random.split(RNG_PHASE_RISK_FACTORS, 0);
+}
+
+/**
+*	@brief Assigns risk factors to the drawn population of an MSA, writes outputs
+*	and releases the population
+*	@param metro is MSA
+*	@return void
+*/
+void CardioModel::finishMetro(Metro *metro)
+{
+	//risk factors of streamed population are assigned PUMA by PUMA in flushPuma()
+	if(parameters->getRunParam()->pop_mode == POP_STREAMING)
+		setFraminghamRiskScore();
+	else
 		setRiskFactors();
 
-		if(parameters->writeToFile())
-			count->output(metro->second.getGeoID());
+	if(parameters->writeToFile())
+		count->output(metro->getGeoID());
+
+	clearList();
+}
 
-		clearList();
-	}*/
+/**
+*	@brief Estimates peak memory of an MSA run: agents with their index entries
+*	and the PUMS records held by IPU
+*	@param metro is MSA
+*	@return estimated bytes
+*/
+size_t CardioModel::getMemoryEstimate(const Metro *metro)
+{
+	const size_t bytes_per_person = sizeof(CardioAgent)+sizeof(AgentPtr::value_type)+EST_BYTES_OVERHEAD;
+	return (size_t)metro->getPopulation()*bytes_per_person;
 }
 
-void CardioModel::createPopulation(Metro *metro)
+void CardioModel::createPopulation(Metro *metro, Random &random)
 {
 	std::cout << "Creating Population for " << metro->getMetroName() << std::endl;
-	metro->createAgents(this);
+	metro->createAgents(this, random);
 }
 
 void CardioModel::addHousehold(const HouseholdPums *h, int)
@@ -56,33 +176,59 @@ void CardioModel::addHousehold(const HouseholdPums *h, int)
 }
 
 void CardioModel::addAgent(const PersonPums *p)
+{
+	addAgent(p, 1);
+}
+
+/**
+*	@brief Adds a person to the CVD population. In weighted population mode
+*	a single agent stands for "weight" persons of the same PUMS record.
+*	@param p is PUMS person (screened by CardioModel::Filter)
+*	@param weight is number of persons represented by the agent
+*	@return void
+*/
+void CardioModel::addAgent(const PersonPums *p, int weight)
 {
 	short int a_ageCat, a_sex, a_org, a_edu;
 	std::string key_map;
-	if(p->getAge() >= 35)
-	{
-		if(p->getOrigin() == ACS::Origin::WhiteNH || p->getOrigin() == ACS::Origin::BlackNH)
-		{
-			CardioAgent *agent = new CardioAgent(p, parameters);
 
-			a_ageCat = agent->getNHANESAgeCat();
-			a_sex = agent->getSex();
-			a_org = agent->getNHANESOrigin();
-			a_edu = agent->getNHANESEduCat();
+	CardioAgent *agent = new CardioAgent(p, parameters);
+	agent->setWeight(weight);
 
-			key_map = std::to_string(a_org)+std::to_string(a_sex)+std::to_string(a_ageCat)+std::to_string(a_edu);
+	a_ageCat = agent->getNHANESAgeCat();
+	a_sex = agent->getSex();
+	a_org = agent->getNHANESOrigin();
+	a_edu = agent->getNHANESEduCat();
 
-			agentList.push_back(*agent);
-			agentsPtrMap.insert(std::make_pair(key_map, &agentList[agentList.size()-1]));
+	key_map = std::to_string(a_org)+std::to_string(a_sex)+std::to_string(a_ageCat)+std::to_string(a_edu);
 
-			count->addPersonCount(a_org, a_sex);
+	agentList.push_back(*agent);
+	agentsPtrMap.insert(std::make_pair(key_map, &agentList[agentList.size()-1]));
+
+	count->addPersonCount(a_org, a_sex, weight);
 					
-			delete agent;
-		}
-	}
+	delete agent;
 }
 
 void CardioModel::setRiskFactors()
+{
+	if(parameters->getRunParam()->pop_mode == POP_WEIGHTED)
+	{
+		setWeightedRiskFactors(riskStream);
+		return;
+	}
+
+	assignRiskFactors(riskStream);
+	setFraminghamRiskScore();
+}
+
+/**
+*	@brief Assigns NHANES risk strata and risk factors to the agents currently held
+*	by the model, matching strata frequencies by person type.
+*	@param random is random number stream of the assignment
+*	@return void
+*/
+void CardioModel::assignRiskFactors(Random &random)
 {
 	std::cout << "Assigning NHANES Risk Factors....\n" << std::endl;
 
@@ -106,7 +252,6 @@ void CardioModel::setRiskFactors()
 	std::vector<PairDD> risk_pair;
 	
 	int counter = 0;
-	Random random;
 	for(auto map_itr = riskStrataMap.begin(); map_itr != riskStrataMap.end(); ++map_itr)
 	{
 		std::cout << "Risk factor assignment for person type: " << map_itr->first << std::endl;
@@ -118,7 +263,7 @@ void CardioModel::setRiskFactors()
 		for(auto agent = pop_range.first; agent != pop_range.second; ++agent)
 		{
 			counter++;
-			boost::range::random_shuffle(map_itr->second);
+			random.shuffle(map_itr->second.begin(), map_itr->second.end());
 			for(auto riskIdx = map_itr->second.begin(); riskIdx != map_itr->second.end();)
 			{
 				if(riskIdx->first == 0)
@@ -156,9 +301,51 @@ void CardioModel::setRiskFactors()
 		}
 	}
 	
+	std::cout << "Assignment Complete! " << std::endl;
+}
+
+/**
+*	@brief Assigns risk strata to weighted agents. Each agent represents a PUMS
+*	record and draws its risk strata from the strata probabilities of its person
+*	type; risk factor sums and counts are accumulated by the agent's weight.
+*	@param random is random number stream of the assignment
+*	@return void
+*/
+void CardioModel::setWeightedRiskFactors(Random &random)
+{
+	std::cout << "Assigning NHANES Risk Factors to weighted records....\n" << std::endl;
+
+	ProbMapRf riskStrataMap = parameters->getRiskStrataProbability();
+
+	for(auto map_itr = riskStrataMap.begin(); map_itr != riskStrataMap.end(); ++map_itr)
+	{
+		auto pop_range = agentsPtrMap.equal_range(map_itr->first);
+		for(auto agent = pop_range.first; agent != pop_range.second; ++agent)
+		{
+			double randomP = random.uniform_real_dist();
+			double cum_prob = 0;
+			int risk_type = (int)map_itr->second.back().second;
+
+			for(auto rf = map_itr->second.begin(); rf != map_itr->second.end(); ++rf)
+			{
+				cum_prob += rf->first;
+				if(randomP < cum_prob)
+				{
+					risk_type = (int)rf->second;
+					break;
+				}
+			}
+
+			int weight = agent->second->getWeight();
+			agent->second->setRiskFactors(random, risk_type);
+
+			count->sumRiskFactors(agent->second, weight);
+			count->addRiskFactorCount(std::to_string(risk_type)+agent->first, weight);
+		}
+	}
+
 	std::cout << "Assignment Complete! " << std::endl;
 	setFraminghamRiskScore();
-	
 }
 
 void CardioModel::setFraminghamRiskScore()
@@ -237,6 +424,20 @@ void CardioModel::setSize(int pop)
 	agentList.reserve(pop);
 }
 
+/**
+*	@brief Streaming sink callback: assigns risk factors to agents of the PUMA
+*	just drawn and releases them before the next PUMA is drawn.
+*	@param puma is PUMA code of streamed households
+*	@return void
+*/
+void CardioModel::flushPuma(int puma)
+{
+	//each PUMA has its own stream, independent of the order PUMAs are flushed
+	Random pumaRandom = riskStream.split(RNG_PHASE_RISK_FACTORS, (uint32_t)puma);
+	assignRiskFactors(pumaRandom);
+	clearList();
+}
+
 void CardioModel::clearList()
 {
 	agentList.clear();
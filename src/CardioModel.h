@@ -7,14 +7,18 @@
 
 #include "CardioAgent.h"
 #include "PopBrewer.h"
+#include "AgentFilter.h"
+#include "Random.h"
 
 //class Parameters;
 class Metro;
 class PersonPums;
 class HouseholdPums;
-class Random;
 class Counter;
 
+//map node, key and PUMS record overhead per person used in memory estimates
+#define EST_BYTES_OVERHEAD 128
+
 class CardioModel : public PopBrewer
 {
 public:
@@ -23,28 +27,49 @@ public:
 	typedef std::map<std::string, double> MapDbl;
 	typedef std::vector<CardioAgent> AgentList;
 	typedef std::multimap<std::string, CardioAgent *> AgentPtr;
+
+	//Only White and Black non-Hispanic adults aged 35 or older enter the CVD model
+	struct Filter : public AcceptAll
+	{
+		static bool acceptPerson(const PersonPums *p)
+		{
+			return (p->getAge() >= 35 && (p->getOrigin() == ACS::Origin::WhiteNH || p->getOrigin() == ACS::Origin::BlackNH));
+		}
+	};
 	
 	CardioModel();
+	CardioModel(std::shared_ptr<Parameters>);
 	virtual ~CardioModel();
 
 	void start();
+	void runMetro(Metro *);
+	void runMetro(Metro *, Random &);
+	void prepareMetro(Metro *, Random &);
+	void finishMetro(Metro *);
 
 	void addHousehold(const HouseholdPums *, int);
 	void addAgent(const PersonPums *);
+	void addAgent(const PersonPums *, int);
 
 	Counter * getCounter() const;
 	EET::Framingham getBeta(int);
 
 	void setSize(int);
+	void flushPuma(int);
 	void clearList();
 
+	static size_t getMemoryEstimate(const Metro *);
+
 private:
-	void createPopulation(Metro *);
+	void createPopulation(Metro *, Random &);
 	void setRiskFactors();
+	void assignRiskFactors(Random &);
+	void setWeightedRiskFactors(Random &);
 	void setFraminghamRiskScore();
 
 	void rounding(std::vector<PairDD>&, double &);
 	Counter *count;
+	Random riskStream; //stream of risk factor assignment, split by PUMA when streaming
 
 	AgentList agentList;
 	AgentPtr agentsPtrMap;
@@ -3,12 +3,16 @@
 #include "ACS.h"
 #include "CardioAgent.h"
 
-Counter::Counter()
+Counter::Counter() : nonPtsdCountSC(0)
 {
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_totDalys[i] = m_totPtsdFreeWeeks[i] = m_totCost[i] = m_avgCost[i] = 0;
 }
 
-Counter::Counter(std::shared_ptr<Parameters> param) : parameters(param)
+Counter::Counter(std::shared_ptr<Parameters> param) : parameters(param), nonPtsdCountSC(0)
 {
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_totDalys[i] = m_totPtsdFreeWeeks[i] = m_totCost[i] = m_avgCost[i] = 0;
 }
 
 Counter::~Counter()
@@ -22,18 +26,18 @@ void Counter::setParameters(std::shared_ptr<Parameters> p)
 
 int Counter::getHouseholdCount(std::string hhType) const
 {
-	if(m_householdCount.count(hhType) > 0)
-		return m_householdCount.at(hhType).size();
-	else
-		return -1;
+	return m_householdCount.get(hhType);
 }
 
 int Counter::getPersonCount(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0)
-		return m_personCount.at(personType).size();
-	else 
-		return -1;
+	return m_personCount.get(personType);
+}
+
+int Counter::getRiskFactorCount(const std::string &rfType) const
+{
+	int count = m_riskFacCount.get(rfType);
+	return (count < 0) ? 0 : count;
 }
 
 void Counter::initialize()
@@ -64,7 +68,7 @@ void Counter::output(std::string geoID)
 	{
 	case EQUITY_EFFICIENCY:
 		{
-			outputRiskFactorPercent();
+			outputRiskFactorPercent(geoID);
 			break;
 		}
 	case MASS_VIOLENCE:
@@ -79,45 +83,220 @@ void Counter::output(std::string geoID)
 	//outputRiskFactorPercent(population);
 }
 
+/**
+*	@brief Adds counts of another counter (e.g. of a worker thread) to this counter.
+*	Typology counts are merged by type, tick counters elementwise, and outcomes 
+*	accumulated over trials are summed.
+*	@param other is counter to be merged
+*	@return void
+*/
+void Counter::merge(const Counter &other)
+{
+	m_householdCount.merge(other.m_householdCount);
+	m_personCount.merge(other.m_personCount);
+	m_riskFacCount.merge(other.m_riskFacCount);
+
+	for(auto type = other.m_sumRiskFac.begin(); type != other.m_sumRiskFac.end(); ++type)
+		for(auto rf = type->second.begin(); rf != type->second.end(); ++rf)
+			m_sumRiskFac[type->first][rf->first] += rf->second;
+
+	nonPtsdCountSC += other.nonPtsdCountSC;
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			mergeTicks(m_ptsdCount[i][j], other.m_ptsdCount[i][j]);
+			mergeTicks(m_ptsdResolvedCount[i][j], other.m_ptsdResolvedCount[i][j]);
+		}
+
+		for(int k = 0; k < NUM_CASES; ++k)
+		{
+			mergeTicks(m_totCbt[i][k], other.m_totCbt[i][k]);
+			mergeTicks(m_totSpr[i][k], other.m_totSpr[i][k]);
+		}
+
+		mergeTicks(m_cbtReach[i], other.m_cbtReach[i]);
+		mergeTicks(m_sprReach[i], other.m_sprReach[i]);
+	}
+
+	mergeTicks(m_cbtCount, other.m_cbtCount);
+	mergeTicks(m_sprCount, other.m_sprCount);
+	mergeTicks(m_ndCount, other.m_ndCount);
+
+	mergeOutcomes(other);
+}
+
+/**
+*	@brief Adds outcomes of a MV model trial, run with its own counter, to the
+*	outcomes accumulated over trials. Household and person counts are those of the
+*	latest draw, as when trials are counted by this counter.
+*	@param trial is counter of the trial
+*	@return void
+*/
+void Counter::mergeTrial(const Counter &trial)
+{
+	m_householdCount = trial.m_householdCount;
+	m_personCount = trial.m_personCount;
+
+	mergeOutcomes(trial);
+}
+
+void Counter::mergeOutcomes(const Counter &other)
+{
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			mergeTicks(m_totPrev[i][j], other.m_totPrev[i][j]);
+			mergeTicks(m_totRecovery[i][j], other.m_totRecovery[i][j]);
+		}
+
+		m_totDalys[i] += other.m_totDalys[i];
+		m_totPtsdFreeWeeks[i] += other.m_totPtsdFreeWeeks[i];
+		m_totCost[i] += other.m_totCost[i];
+		m_avgCost[i] += other.m_avgCost[i];
+	}
+
+	if(m_prevalence.size() < other.m_prevalence.size())
+		m_prevalence.resize(other.m_prevalence.size(), Outcomes());
+	if(m_recovery.size() < other.m_recovery.size())
+		m_recovery.resize(other.m_recovery.size(), Outcomes());
+
+	for(size_t t = 0; t < other.m_prevalence.size(); ++t)
+	{
+		for(int i = 0; i < NUM_TREATMENT; ++i)
+			m_prevalence[t].value[i] += other.m_prevalence[t].value[i];
+
+		m_prevalence[t].diff += other.m_prevalence[t].diff;
+		m_prevalence[t].ratio += other.m_prevalence[t].ratio;
+	}
+
+	for(size_t t = 0; t < other.m_recovery.size(); ++t)
+	{
+		for(int i = 0; i < NUM_TREATMENT; ++i)
+			m_recovery[t].value[i] += other.m_recovery[t].value[i];
+
+		m_recovery[t].diff += other.m_recovery[t].diff;
+		m_recovery[t].ratio += other.m_recovery[t].ratio;
+	}
+}
+
+/**
+*	@brief Prepares a counter shard: only the counts recorded by agents during a
+*	tick (PTSD, resolution, reach and treatment counts) are kept
+*	@return void
+*/
+void Counter::initShard()
+{
+	initPtsdCounter();
+}
+
+/**
+*	@brief Moves the counts recorded by a shard during a tick into this counter
+*	and clears them in the shard. Counts are integers, so the result does not 
+*	depend on the order in which shards are merged.
+*	@param shard is counter shard of a block of agents
+*	@param tick is tick
+*	@return void
+*/
+void Counter::mergeTick(Counter *shard, int tick)
+{
+	int year = getYear(tick);
+
+	nonPtsdCountSC += shard->nonPtsdCountSC;
+	shard->nonPtsdCountSC = 0;
+
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			addAt(m_ptsdCount[i][j], tick, shard->m_ptsdCount[i][j][tick]);
+			addAt(m_ptsdResolvedCount[i][j], tick, shard->m_ptsdResolvedCount[i][j][tick]);
+			shard->m_ptsdCount[i][j][tick] = shard->m_ptsdResolvedCount[i][j][tick] = 0;
+		}
+
+		for(int k = 0; k < NUM_CASES; ++k)
+		{
+			if((size_t)year < shard->m_totCbt[i][k].size())
+			{
+				addAt(m_totCbt[i][k], year, shard->m_totCbt[i][k][year]);
+				addAt(m_totSpr[i][k], year, shard->m_totSpr[i][k][year]);
+				shard->m_totCbt[i][k][year] = shard->m_totSpr[i][k][year] = 0;
+			}
+		}
+
+		addAt(m_cbtReach[i], tick, shard->m_cbtReach[i][tick]);
+		addAt(m_sprReach[i], tick, shard->m_sprReach[i][tick]);
+		shard->m_cbtReach[i][tick] = shard->m_sprReach[i][tick] = 0;
+	}
+
+	addAt(m_cbtCount, tick, shard->m_cbtCount[tick]);
+	addAt(m_sprCount, tick, shard->m_sprCount[tick]);
+	addAt(m_ndCount, tick, shard->m_ndCount[tick]);
+	shard->m_cbtCount[tick] = shard->m_sprCount[tick] = shard->m_ndCount[tick] = 0;
+}
+
+/**
+*	@brief Resets the counts of a MV model trial whose population is restored
+*	instead of drawn (see CountSink::begin()); household and person counts are 
+*	those of the latest draw
+*	@return void
+*/
+void Counter::initTrial()
+{
+	initPtsdCounter();
+}
+
+/**
+*	@brief Resets outcomes accumulated over trials
+*	@return void
+*/
+void Counter::clearOutcomes()
+{
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			m_totPrev[i][j].clear();
+			m_totRecovery[i][j].clear();
+		}
+
+		m_totDalys[i] = m_totPtsdFreeWeeks[i] = m_totCost[i] = m_avgCost[i] = 0;
+	}
+
+	m_prevalence.clear();
+	m_recovery.clear();
+}
+
 void Counter::initHouseholdCounter()
 {
-	clearMap(m_householdCount);
+	m_householdCount.clear();
 
-	std::vector<bool> hhCounts;
-	hhCounts.reserve(0);
-	
 	const Pool *householdsPool = parameters->getHouseholdPool();
-
 	for(size_t hh = 0; hh < householdsPool->size(); ++hh)
-		m_householdCount.insert(std::make_pair(householdsPool->at(hh), hhCounts));
-
+		m_householdCount.insert(householdsPool->at(hh));
 }
 
 void Counter::initPersonCounter()
 {
-	clearMap(m_personCount);
+	m_personCount.clear();
 
-	std::vector<bool> personCounts;
-	personCounts.reserve(0);
-	
+	//person types are inserted in pool order: count index is pool position (see addPersonCountAt)
 	const Pool *indivPool = parameters->getPersonPool();
 	for(size_t pp = 0; pp < indivPool->size(); ++pp)
-		m_personCount.insert(std::make_pair(indivPool->at(pp), personCounts));
+		m_personCount.insert(indivPool->at(pp));
 }
 
 void Counter::initRiskFacCounter()
 {
-	clearMap(m_riskFacCount);
+	m_riskFacCount.clear();
 	m_sumRiskFac.clear();
-	
-	std::vector<bool> riskFacCounts;
-	riskFacCounts.reserve(0);
 
 	const int num_risk_strata = 16;
 	const Pool *nhanesPool = parameters->getNhanesPool();
 	for(size_t nh = 0; nh < nhanesPool->size(); ++nh)
 		for(size_t rf = 1; rf <= num_risk_strata; ++rf)
-			m_riskFacCount.insert(std::make_pair(std::to_string(rf)+nhanesPool->at(nh), riskFacCounts));			
+			m_riskFacCount.insert(std::to_string(rf)+nhanesPool->at(nh));
 }
 
 void Counter::initPtsdCounter()
@@ -129,18 +308,12 @@ void Counter::initPtsdCounter()
 	{
 		for(int j = 0; j < NUM_PTSD; ++j)
 		{
-			for(int k = 0; k < num_steps; ++k)
-			{
-				m_ptsdCount[i][j].insert(std::make_pair(k, 0));
-				m_ptsdResolvedCount[i][j].insert(std::make_pair(k, 0));
-
-				if(j == 0)
-				{
-					m_cbtReach[i].insert(std::make_pair(k, 0));
-					m_sprReach[i].insert(std::make_pair(k, 0));
-				}
-			}	
+			m_ptsdCount[i][j].assign(num_steps, 0);
+			m_ptsdResolvedCount[i][j].assign(num_steps, 0);
 		}
+
+		m_cbtReach[i].assign(num_steps, 0);
+		m_sprReach[i].assign(num_steps, 0);
 	}
 
 	initTreatmentCounter(num_steps);
@@ -149,73 +322,82 @@ void Counter::initPtsdCounter()
 
 void Counter::initTreatmentCounter(int steps)
 {
-	for(int i = 0; i < steps; ++i)
-	{
-		m_cbtCount.insert(std::make_pair(i, 0));
-		m_sprCount.insert(std::make_pair(i, 0));
-		m_ndCount.insert(std::make_pair(i, 0));
-	}
+	m_cbtCount.assign(steps, 0);
+	m_sprCount.assign(steps, 0);
+	m_ndCount.assign(steps, 0);
 
-	for(int i = 0; i < steps/WEEKS_IN_YEAR; ++i)
+	for(int j = 0; j < NUM_TREATMENT; ++j)
 	{
-		//m_totCbt.insert(std::make_pair(i, 0));
-		for(int j = 0; j < NUM_TREATMENT; ++j)
+		for(int k = 0; k < NUM_CASES; ++k)
 		{
-			for(int k = 0; k < NUM_CASES; ++k)
-			{
-				m_totCbt[j][k].insert(std::make_pair(i, 0));
-				m_totSpr[j][k].insert(std::make_pair(i, 0));
-			}
+			m_totCbt[j][k].assign(steps/WEEKS_IN_YEAR, 0);
+			m_totSpr[j][k].assign(steps/WEEKS_IN_YEAR, 0);
 		}
 	}
-
 }
 
 
 void Counter::addHouseholdCount(std::string hhType)
 {
-	if (m_householdCount.count(hhType) > 0)
-		m_householdCount[hhType].push_back(true);
+	addHouseholdCount(hhType, 1);
 }
 
 void Counter::addPersonCount(std::string personType)
 {
-	if(m_personCount.count(personType) > 0)
-		m_personCount[personType].push_back(true);
+	addPersonCount(personType, 1);
 }
 
 void Counter::addPersonCount(int origin, int sex)
 {
+	addPersonCount(origin, sex, 1);
+}
+
+void Counter::addHouseholdCount(std::string hhType, int weight)
+{
+	m_householdCount.add(hhType, weight);
+}
+
+void Counter::addPersonCount(std::string personType, int weight)
+{
+	m_personCount.add(personType, weight);
+}
+
+void Counter::addPersonCount(int origin, int sex, int weight)
+{
+	//origin-sex types of the CVD model are not part of the person pool
 	std::string agentType = std::to_string(origin)+std::to_string(sex);
-	if(m_personCount.count(agentType) == 0)
-	{
-		std::vector<bool>count;
-		count.push_back(true);
+	m_personCount.counts[m_personCount.insert(agentType)] += weight;
+}
 
-		m_personCount.insert(std::make_pair(agentType, count));
-	}
-	else
-	{
-		m_personCount[agentType].push_back(true);
-	}
+void Counter::addPersonCountAt(int idx, int weight)
+{
+	if(idx >= 0)
+		m_personCount.counts[idx] += weight;
 }
 
 void Counter::addRiskFactorCount(std::string rfType)
 {
-	if(m_riskFacCount.count(rfType) > 0)
-		m_riskFacCount[rfType].push_back(true);
-	
+	addRiskFactorCount(rfType, 1);
+}
+
+void Counter::addRiskFactorCount(std::string rfType, int weight)
+{
+	m_riskFacCount.add(rfType, weight);
 }
 
 void Counter::sumRiskFactors(CardioAgent *agent)
 {
-	accumulateRiskFacs(agent);
+	accumulateRiskFacs(agent, 1);
+}
+
+void Counter::sumRiskFactors(CardioAgent *agent, int weight)
+{
+	accumulateRiskFacs(agent, weight);
 }
 
 void Counter::addPtsdCount(int treatment, int ptsd_type, int tick)
 {
-	if(m_ptsdCount[treatment][ptsd_type].count(tick) > 0)
-		m_ptsdCount[treatment][ptsd_type].at(tick) += 1;
+	addAt(m_ptsdCount[treatment][ptsd_type], tick, 1);
 }
 
 void Counter::addCbtReferredNonPtsd()
@@ -225,76 +407,67 @@ void Counter::addCbtReferredNonPtsd()
 
 void Counter::addPtsdResolvedCount(int treatment, int ptsd_type, int tick)
 {
-	if(m_ptsdResolvedCount[treatment][ptsd_type].count(tick) > 0)
-		m_ptsdResolvedCount[treatment][ptsd_type].at(tick) += 1;
+	addAt(m_ptsdResolvedCount[treatment][ptsd_type], tick, 1);
 }
 
 void Counter::addCbtReach(int treatment, int tick)
 {
-	if(m_cbtReach[treatment].count(tick) > 0)
-		m_cbtReach[treatment].at(tick) += 1;
+	addAt(m_cbtReach[treatment], tick, 1);
 }
 
 void Counter::addSprReach(int treatment, int tick)
 {
-	if(m_sprReach[treatment].count(tick) > 0)
-		m_sprReach[treatment].at(tick) += 1;
+	addAt(m_sprReach[treatment], tick, 1);
 }
 
-void Counter::addCbtCount(ViolenceAgent *agent, int tick, int treatment)
+void Counter::addCbtCount(const PtsdState *state, int id, int tick, int treatment)
 {
 	if(treatment == STEPPED_CARE)
 	{
-		if(agent->getPTSDx(treatment) >= agent->getPtsdCutOff())
-		{
-			if(m_cbtCount.count(tick) > 0)
-				m_cbtCount[tick] += 1;
-		}
+		double cutoff = state->getPtsdCutOff();
+		if(state->getPTSDx(id, treatment) >= cutoff)
+			addAt(m_cbtCount, tick, 1);
 
-		if(agent->getCBTReferred())
+		if(state->getCBTReferred(id))
 		{
-			int week = (tick+1);
-			int year = (week % WEEKS_IN_YEAR == 0) ? ((week/WEEKS_IN_YEAR)-1) : (week/WEEKS_IN_YEAR);
+			int year = getYear(tick);
 
 			//counts number of CBT sessions received by PTSD cases and non-cases(screened incorrectly as cases)
-			if(agent->getInitPTSDx() >= agent->getPtsdCutOff())
+			if(state->getInitPTSDx(id) >= cutoff)
 				m_totCbt[treatment][PTSD_CASE].at(year) += 1;
-			else if(agent->getInitPTSDx() < agent->getPtsdCutOff())
+			else if(state->getInitPTSDx(id) < cutoff)
 				m_totCbt[treatment][PTSD_NON_CASE].at(year) += 1;
 		}
 	}
 }
 
-void Counter::addSprCount(ViolenceAgent *agent, int tick, int treatment)
+void Counter::addSprCount(const PtsdState *state, int id, int tick, int treatment)
 {
-	int week = (tick+1);
-	int year = (week % WEEKS_IN_YEAR == 0) ? ((week/WEEKS_IN_YEAR)-1) : (week/WEEKS_IN_YEAR);
+	int year = getYear(tick);
+	double cutoff = state->getPtsdCutOff();
 
 	if(treatment == STEPPED_CARE)
 	{
-		if(agent->getPTSDx(treatment) >= agent->getPtsdCutOff())
-		{
-			if(m_sprCount.count(tick) > 0)
-				m_sprCount[tick] += 1;
-		}
+		if(state->getPTSDx(id, treatment) >= cutoff)
+			addAt(m_sprCount, tick, 1);
 
-		if(agent->getCBTReferred())
+		if(state->getCBTReferred(id))
 		{
 			//counts number of SPR sessions received by PTSD cases and non-cases(screened incorrectly as cases)
-			if(agent->getInitPTSDx() >= agent->getPtsdCutOff())
+			if(state->getInitPTSDx(id) >= cutoff)
 				m_totSpr[treatment][PTSD_CASE].at(year) += 1;
-			else if(agent->getInitPTSDx() < agent->getPtsdCutOff())
+			else if(state->getInitPTSDx(id) < cutoff)
 				m_totSpr[treatment][PTSD_NON_CASE].at(year) += 1;
 		}
-		else if(agent->getSPRReferred())
+		else if(state->getSPRReferred(id))
 		{
-			if(agent->getInitPTSDx() >= agent->getPtsdCutOff())
+			if(state->getInitPTSDx(id) >= cutoff)
 				m_totSpr[treatment][PTSD_CASE].at(year) += 1;
 		}
 	}
 	else if(treatment == USUAL_CARE)
 	{
-		if(agent->getInitPTSDx() >= agent->getPtsdCutOff())
+		if(state->getInitPTSDx(id) >= cutoff)
 			m_totSpr[treatment][PTSD_CASE].at(year) += 1;
 	}
 	
@@ -302,8 +475,13 @@ void Counter::addSprCount(ViolenceAgent *agent, int tick, int treatment)
 
 void Counter::addNaturalDecayCount(int tick)
 {
-	if(m_ndCount.count(tick) > 0)
-		m_ndCount[tick] += 1;
+	addAt(m_ndCount, tick, 1);
+}
+
+int Counter::getYear(int tick) const
+{
+	int week = (tick+1);
+	return (week % WEEKS_IN_YEAR == 0) ? ((week/WEEKS_IN_YEAR)-1) : (week/WEEKS_IN_YEAR);
 }
 
 void Counter::computeOutcomes(int tick, int totPop)
@@ -312,12 +490,12 @@ void Counter::computeOutcomes(int tick, int totPop)
 	computeRecovery(tick, totPop);
 }
 
-void Counter::computeCostEffectiveness(AgentListPtr *agentList)
+void Counter::computeCostEffectiveness(const PtsdState *state, const AgentIDs *agents)
 {
 	//std::cout << std::endl;
 	//std::cout << "Cost Effectiveness Analysis in progress...." << std::endl;
 
-	computeDALYs(agentList);
+	computeDALYs(state, agents);
 	computeTotalCost();
 	computeAverageCost();
 
@@ -344,10 +522,9 @@ void Counter::computePrevalence(int tick, int totPop)
 			double pts_count = m_ptsdCount[i][j].at(tick);
 			double prev = (double)pts_count/totPop;
 
-			if(m_totPrev[i][j].count(tick) > 0)
-				m_totPrev[i][j].at(tick) += prev;
-			else
-				m_totPrev[i][j].insert(std::make_pair(tick, prev));
+			if(m_totPrev[i][j].size() <= (size_t)tick)
+				m_totPrev[i][j].resize(tick+1, 0);
+			m_totPrev[i][j][tick] += prev;
 
 			ptsd_count[i] += pts_count;
 		}
@@ -361,18 +538,14 @@ void Counter::computePrevalence(int tick, int totPop)
 	prevalence.diff = computeDiff(prevalence.value, stdErr.first);
 	prevalence.ratio = computeRatio(prevalence.value, stdErr.second);
 
-	if(m_prevalence.count(tick) > 0)
-	{
-		for(int i = 0; i < NUM_TREATMENT; ++i)
-			m_prevalence[tick].value[i] += prevalence.value[i];
+	if(m_prevalence.size() <= (size_t)tick)
+		m_prevalence.resize(tick+1, Outcomes());
 
-		m_prevalence[tick].diff += prevalence.diff;
-		m_prevalence[tick].ratio += prevalence.ratio;
-	}
-	else
-	{
-		m_prevalence.insert(std::make_pair(tick, prevalence));
-	}
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_prevalence[tick].value[i] += prevalence.value[i];
+
+	m_prevalence[tick].diff += prevalence.diff;
+	m_prevalence[tick].ratio += prevalence.ratio;
 	
 }
 
@@ -396,10 +569,9 @@ void Counter::computeRecovery(int tick, int totPop)
 			double res_count = m_ptsdResolvedCount[i][j].at(tick);
 			double recov = pts_count/(pts_count+res_count);
 
-			if(m_totRecovery[i][j].count(tick) > 0)
-				m_totRecovery[i][j].at(tick) += recov;
-			else
-				m_totRecovery[i][j].insert(std::make_pair(tick, recov));
+			if(m_totRecovery[i][j].size() <= (size_t)tick)
+				m_totRecovery[i][j].resize(tick+1, 0);
+			m_totRecovery[i][j][tick] += recov;
 
 			ptsd_count[i] += pts_count;
 			ptsd_resolved[i] += res_count;
@@ -412,22 +584,18 @@ void Counter::computeRecovery(int tick, int totPop)
 	recovery.diff = computeDiff(recovery.value, stdErr.first);
 	recovery.ratio = computeRatio(recovery.value, stdErr.second);
 
-	if(m_recovery.count(tick) > 0)
-	{
-		for(int i = 0; i < NUM_TREATMENT; ++i)
-			m_recovery[tick].value[i] += recovery.value[i];
+	if(m_recovery.size() <= (size_t)tick)
+		m_recovery.resize(tick+1, Outcomes());
 
-		m_recovery[tick].diff += recovery.diff;
-		m_recovery[tick].ratio += recovery.ratio;
-	}
-	else
-	{
-		m_recovery.insert(std::make_pair(tick, recovery));
-	}
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_recovery[tick].value[i] += recovery.value[i];
+
+	m_recovery[tick].diff += recovery.diff;
+	m_recovery[tick].ratio += recovery.ratio;
 	
 }
 
-void Counter::computeDALYs(AgentListPtr *agentList)
+void Counter::computeDALYs(const PtsdState *state, const AgentIDs *agents)
 {
 	double dw_mild, dw_mod, dw_sev;
 
@@ -435,26 +603,17 @@ void Counter::computeDALYs(AgentListPtr *agentList)
 	dw_mod = parameters->getViolenceParam()->dw_moderate;
 	dw_sev = parameters->getViolenceParam()->dw_severe;
 
-	for(auto pp = agentList->begin(); pp != agentList->end(); ++pp)
+	for(auto id = agents->begin(); id != agents->end(); ++id)
 	{
-		ViolenceAgent *agent = *pp;
 		for(int i = 0; i < NUM_TREATMENT; ++i)
 		{
-			double daly = getYLD(dw_mild, agent->getDurationMild(i))
-				+ getYLD(dw_mod, agent->getDurationModerate(i)) + getYLD(dw_sev, agent->getDurationSevere(i));
+			double daly = getYLD(dw_mild, state->getDurationMild(*id, i))
+				+ getYLD(dw_mod, state->getDurationModerate(*id, i)) + getYLD(dw_sev, state->getDurationSevere(*id, i));
 
-			if(m_totDalys.count(i) > 0)
-				m_totDalys[i] += daly;
-			else
-				m_totDalys.insert(std::make_pair(i, daly));
+			m_totDalys[i] += daly;
 
-			if(agent->getInitPTSDx() >= agent->getPtsdCutOff())
-			{
-				if(m_totPtsdFreeWeeks.count(i) > 0)
-					m_totPtsdFreeWeeks[i] += agent->getResolvedTime(i);
-				else
-					m_totPtsdFreeWeeks.insert(std::make_pair(i, agent->getResolvedTime(i)));
-			}
+			if(state->getInitPTSDx(*id) >= state->getPtsdCutOff())
+				m_totPtsdFreeWeeks[i] += state->getResolvedTime(*id, i);
 		}
 	}
 }
@@ -464,11 +623,7 @@ void Counter::computeTotalCost()
 	for(int i = 0; i < NUM_TREATMENT; ++i)
 	{
 		
-		double tot_cost = getTotalCost(i);
-		if(m_totCost.count(i) > 0)
-			m_totCost.at(i) += tot_cost;
-		else
-			m_totCost.insert(std::make_pair(i, tot_cost));
+		m_totCost[i] += getTotalCost(i);
 	}
 }
 
@@ -520,10 +675,7 @@ void Counter::computeAverageCost()
 			avg_cost = spr_cost*avg_spr_visits;
 		}
 
-		if(m_avgCost.count(i) > 0)
-			m_avgCost[i] += avg_cost;
-		else
-			m_avgCost.insert(std::make_pair(i, avg_cost));
+		m_avgCost[i] += avg_cost;
 	}	
 
 }
@@ -653,7 +805,7 @@ double Counter::getTotalCost(int trtment)
 	return tot_cost;
 }
 
-void Counter::accumulateRiskFacs(CardioAgent *agent)
+void Counter::accumulateRiskFacs(CardioAgent *agent, int weight)
 {
 	std::string agentType = std::to_string(agent->getNHANESOrigin())+std::to_string(agent->getSex());
 	
@@ -665,45 +817,35 @@ void Counter::accumulateRiskFacs(CardioAgent *agent)
 		for(auto rf : NHANES::RiskFac::_values())
 			rfs.insert(std::make_pair(rf, 0));
 
-		rfs[NHANES::AgeCat::Age_35_44-1] = agent->getAge();
-		rfs[NHANES::RiskFac::totalChols] = agent->getRiskChart().tchols;
-		rfs[NHANES::RiskFac::HdlChols] = agent->getRiskChart().hdlChols;
-		rfs[NHANES::RiskFac::SystolicBp] = agent->getRiskChart().systolicBp;
-		
-		if(agent->getRiskChart().smokingStatus)
-			rfs[NHANES::RiskFac::SmokingStat]++;
-
 		m_sumRiskFac.insert(std::make_pair(agentType, rfs));
 	}
-	else
-	{
-		m_sumRiskFac[agentType][NHANES::AgeCat::Age_35_44-1] += agent->getAge();
-		m_sumRiskFac[agentType][NHANES::RiskFac::totalChols] += agent->getRiskChart().tchols;
-		m_sumRiskFac[agentType][NHANES::RiskFac::HdlChols] += agent->getRiskChart().hdlChols;
-		m_sumRiskFac[agentType][NHANES::RiskFac::SystolicBp] += agent->getRiskChart().systolicBp;
 
-		if(agent->getRiskChart().smokingStatus)
-			m_sumRiskFac[agentType][NHANES::RiskFac::SmokingStat]++;
-	}
+	m_sumRiskFac[agentType][NHANES::AgeCat::Age_35_44-1] += weight*agent->getAge();
+	m_sumRiskFac[agentType][NHANES::RiskFac::totalChols] += weight*agent->getRiskChart().tchols;
+	m_sumRiskFac[agentType][NHANES::RiskFac::HdlChols] += weight*agent->getRiskChart().hdlChols;
+	m_sumRiskFac[agentType][NHANES::RiskFac::SystolicBp] += weight*agent->getRiskChart().systolicBp;
+
+	if(agent->getRiskChart().smokingStatus)
+		m_sumRiskFac[agentType][NHANES::RiskFac::SmokingStat] += weight;
 }
 
 
 double Counter::getMeanAge(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0 && m_sumRiskFac.count(personType) > 0)
+	if(m_personCount.get(personType) >= 0 && m_sumRiskFac.count(personType) > 0)
 	{
 		double sum_age = m_sumRiskFac.at(personType).at(NHANES::AgeCat::Age_35_44-1);
-		return sum_age/m_personCount.at(personType).size();
+		return sum_age/m_personCount.get(personType);
 	}
 	else
 		return -1;
 }
 double Counter::getMeanTchols(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0 && m_sumRiskFac.count(personType) > 0)
+	if(m_personCount.get(personType) >= 0 && m_sumRiskFac.count(personType) > 0)
 	{
 		double sum_tchols = m_sumRiskFac.at(personType).at(NHANES::RiskFac::totalChols);
-		return sum_tchols/m_personCount.at(personType).size();
+		return sum_tchols/m_personCount.get(personType);
 	}
 	else
 		return -1;
@@ -711,10 +853,10 @@ double Counter::getMeanTchols(std::string personType) const
 
 double Counter::getMeanHChols(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0 && m_sumRiskFac.count(personType) > 0)
+	if(m_personCount.get(personType) >= 0 && m_sumRiskFac.count(personType) > 0)
 	{
 		double sum_hchols = m_sumRiskFac.at(personType).at(NHANES::RiskFac::HdlChols);
-		return sum_hchols/m_personCount.at(personType).size();
+		return sum_hchols/m_personCount.get(personType);
 	}
 	else
 		return -1;
@@ -722,10 +864,10 @@ double Counter::getMeanHChols(std::string personType) const
 
 double Counter::getMeanBP(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0 && m_sumRiskFac.count(personType) > 0)
+	if(m_personCount.get(personType) >= 0 && m_sumRiskFac.count(personType) > 0)
 	{
 		double sum_bp = m_sumRiskFac.at(personType).at(NHANES::RiskFac::SystolicBp);
-		return sum_bp/m_personCount.at(personType).size();
+		return sum_bp/m_personCount.get(personType);
 	}
 	else
 		return -1;
@@ -733,10 +875,10 @@ double Counter::getMeanBP(std::string personType) const
 
 double Counter::getPercentSmoking(std::string personType) const
 {
-	if(m_personCount.count(personType) > 0 && m_sumRiskFac.count(personType) > 0)
+	if(m_personCount.get(personType) >= 0 && m_sumRiskFac.count(personType) > 0)
 	{
 		double sum_smoking = m_sumRiskFac.at(personType).at(NHANES::RiskFac::SmokingStat);
-		return sum_smoking/m_personCount.at(personType).size();
+		return sum_smoking/m_personCount.get(personType);
 	}
 	else
 		return -1;
@@ -767,9 +909,8 @@ void Counter::outputHouseholdCounts(std::string geoID)
 			for(auto hhInc : ACS::HHIncome::_values())
 			{
 				std::string var_type = std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc);
-				//countHHSize += m_householdCount.count(var_type);
-				if(m_householdCount.count(var_type) > 0)
-					countHHSize += m_householdCount[var_type].size();
+				if(m_householdCount.get(var_type) > 0)
+					countHHSize += m_householdCount.get(var_type);
 			}
 			hhFile << countHHSize << ",";
 		}
@@ -792,9 +933,8 @@ void Counter::outputHouseholdCounts(std::string geoID)
 			for(auto hhSize : ACS::HHSize::_values())
 			{
 				std::string var_type = std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc);
-				//countHHInc += m_householdCount.count(var_type);
-				if(m_householdCount.count(var_type) > 0)
-					countHHInc += m_householdCount[var_type].size();
+				if(m_householdCount.get(var_type) > 0)
+					countHHInc += m_householdCount.get(var_type);
 			}
 			hhFile << countHHInc << ",";
 		}
@@ -831,9 +971,8 @@ void Counter::outputPersonCounts(std::string geoID)
 			for(auto org : ACS::Origin::_values())
 			{
 				std::string type = dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org);
-				//countAge += m_personCount.count(type);
-				if(m_personCount.count(type) > 0)
-					countAge += m_personCount[type].size();
+				if(m_personCount.get(type) > 0)
+					countAge += m_personCount.get(type);
 			}
 			pFile << countAge << ",";
 		}
@@ -855,9 +994,8 @@ void Counter::outputPersonCounts(std::string geoID)
 			for(auto ageCat : ACS::AgeCat::_values())
 			{
 				std::string type = dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org);
-				//countOrigin += m_personCount.count(type);
-				if(m_personCount.count(type) > 0)
-					countOrigin += m_personCount[type].size();
+				if(m_personCount.get(type) > 0)
+					countOrigin += m_personCount.get(type);
 			}
 			pFile << countOrigin << ",";
 		}
@@ -883,8 +1021,8 @@ void Counter::outputPersonCounts(std::string geoID)
 				for(auto org : ACS::Origin::_values())
 				{
 					std::string type = std::to_string(sex)+std::to_string(eduAge)+std::to_string(org)+std::to_string(edu);
-					if(m_personCount.count(type) > 0)
-						countEdu += m_personCount[type].size();
+					if(m_personCount.get(type) > 0)
+						countEdu += m_personCount.get(type);
 				}
 				pFile << countEdu << ",";
 			}
@@ -895,11 +1033,12 @@ void Counter::outputPersonCounts(std::string geoID)
 	pFile << std::endl;
 }
 
-void Counter::outputRiskFactorPercent()
+void Counter::outputRiskFactorPercent(std::string geoID)
 {
 	std::ofstream rfile;
-	std::string fileName = "risk_factor_props.csv";
+	std::string fileName = "risk_factors/" + geoID + "_risk_factor_props.csv";
 
+	Parameters::createDirectory(parameters->getOutputDir()+"risk_factors/");
 	rfile.open(parameters->getOutputDir()+fileName);
 
 	if(!rfile.is_open())
@@ -919,7 +1058,7 @@ void Counter::outputRiskFactorPercent()
 		for(size_t i = 1; i <= num_risk_strata; ++i)
 		{
 			std::string key = std::to_string(i)+nhanesPool->at(nh);
-			count += m_riskFacCount[key].size();
+			count += getRiskFactorCount(key);
 		}
 		popCountType.insert(std::make_pair(nhanesPool->at(nh), count));
 	}
@@ -937,7 +1076,7 @@ void Counter::outputRiskFactorPercent()
 
 					for(size_t rf = 1; rf <= num_risk_strata; ++rf)
 					{
-						double count = m_riskFacCount[std::to_string(rf)+key].size();
+						double count = getRiskFactorCount(std::to_string(rf)+key);
 
 						rfile << rf << "," << org._to_string() << "," << sex._to_string() << "," << age._to_string() << ","
 							<< edu._to_string() << "," << 100*count/total << std::endl;
@@ -1062,16 +1201,71 @@ void Counter::outputCostEffectiveness()
 	std::cout << "Analysis complete!" << std::endl;
 }
 
-void Counter::clearMap(TypeMap &type)
+void Counter::addAt(TickInts &ticks, int tick, int num)
 {
-	for(auto map = type.begin(); map != type.end(); ++map)
-	{
-		map->second.clear();
-		map->second.shrink_to_fit();
-	}
+	if(tick >= 0 && (size_t)tick < ticks.size())
+		ticks[tick] += num;
+}
 
-	type.clear();
+void Counter::mergeTicks(TickInts &ticks, const TickInts &other)
+{
+	if(ticks.size() < other.size())
+		ticks.resize(other.size(), 0);
 
+	for(size_t t = 0; t < other.size(); ++t)
+		ticks[t] += other[t];
+}
+
+void Counter::mergeTicks(TickDbls &ticks, const TickDbls &other)
+{
+	if(ticks.size() < other.size())
+		ticks.resize(other.size(), 0);
+
+	for(size_t t = 0; t < other.size(); ++t)
+		ticks[t] += other[t];
+}
+
+int Counter::TypeCounts::indexOf(const std::string &type) const
+{
+	auto it = index.find(type);
+	return (it != index.end()) ? it->second : -1;
+}
+
+int Counter::TypeCounts::insert(const std::string &type)
+{
+	auto it = index.find(type);
+	if(it != index.end())
+		return it->second;
+
+	index.insert(std::make_pair(type, (int)counts.size()));
+	counts.push_back(0);
+
+	return (int)counts.size()-1;
+}
+
+int Counter::TypeCounts::get(const std::string &type) const
+{
+	int idx = indexOf(type);
+	return (idx >= 0) ? counts[idx] : -1;
+}
+
+void Counter::TypeCounts::add(const std::string &type, int weight)
+{
+	int idx = indexOf(type);
+	if(idx >= 0)
+		counts[idx] += weight;
+}
+
+void Counter::TypeCounts::merge(const TypeCounts &other)
+{
+	for(auto it = other.index.begin(); it != other.index.end(); ++it)
+		counts[insert(it->first)] += other.counts[it->second];
+}
+
+void Counter::TypeCounts::clear()
+{
+	index.clear();
+	counts.clear();
 }
 
 void Counter::clearCounter()
@@ -5,12 +5,14 @@
 #include <iomanip>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <memory>
 #include <fstream>
 #include <cmath>
 
 #include "ViolenceAgent.h"
+#include "PtsdState.h"
 
 class Parameters;
 class CardioAgent;
@@ -60,14 +62,30 @@ struct Outcomes
 class Counter
 {
 public:
-	typedef std::map<std::string, std::vector<bool>> TypeMap;
 	typedef std::map<int, int> MapInts;
 	typedef std::map<int, double> MapDbls;
-	typedef std::map<int, Outcomes> MapOutcomes;
+	typedef std::unordered_map<std::string, int> IndexMap;
+	typedef std::vector<int> TickInts;
+	typedef std::vector<double> TickDbls;
+	typedef std::vector<Outcomes> TickOutcomes;
+
+	//dense counts of a typology; keys are mapped once to array indices
+	struct TypeCounts
+	{
+		IndexMap index;
+		std::vector<int> counts;
+
+		int indexOf(const std::string &) const;
+		int insert(const std::string &);
+		int get(const std::string &) const;
+		void add(const std::string &, int);
+		void merge(const TypeCounts &);
+		void clear();
+	};
 	typedef std::vector<std::string> Pool;
 	typedef std::pair<double, double> Pair;
 	typedef std::map<std::string, std::map<int, double>> RiskFacMap;
-	typedef std::vector<ViolenceAgent*> AgentListPtr;
+	typedef std::vector<int> AgentIDs;
 	typedef std::vector<double> VectorDbls;
 
 	Counter();
@@ -80,6 +98,14 @@ public:
 	int getHouseholdCount(std::string) const;
 
 	void initialize();
+	void merge(const Counter &);
+	void mergeTrial(const Counter &);
+	void initTrial();
+	void clearOutcomes();
+
+	//MV model: counter shard of a block of agents within a tick
+	void initShard();
+	void mergeTick(Counter *, int);
 	//void reset();
 	void output(std::string);
 
@@ -87,9 +113,19 @@ public:
 	void addPersonCount(std::string);
 	void addPersonCount(int, int);
 
+	//weighted records (counts incremented by record weight)
+	void addHouseholdCount(std::string, int);
+	void addPersonCount(std::string, int);
+	void addPersonCount(int, int, int);
+
+	//O(1) increment by person pool index (see Parameters::getPersonPoolIndex)
+	void addPersonCountAt(int, int);
+
 	//CVD model
 	void addRiskFactorCount(std::string);
+	void addRiskFactorCount(std::string, int);
 	void sumRiskFactors(CardioAgent *);
+	void sumRiskFactors(CardioAgent *, int);
 
 	//MV model
 	void addPtsdCount(int, int, int);
@@ -97,12 +133,12 @@ public:
 	void addPtsdResolvedCount(int, int, int);
 	void addCbtReach(int, int);
 	void addSprReach(int, int);
-	void addCbtCount(ViolenceAgent*, int, int);
-	void addSprCount(ViolenceAgent*, int, int);
+	void addCbtCount(const PtsdState *, int, int, int);
+	void addSprCount(const PtsdState *, int, int, int);
 	void addNaturalDecayCount(int);
 
 	void computeOutcomes(int, int);
-	void computeCostEffectiveness(AgentListPtr *);
+	void computeCostEffectiveness(const PtsdState *, const AgentIDs *);
 
 	//MV model
 	VectorDbls getPrevalence(int, int);
@@ -122,7 +158,7 @@ public:
 	void outputHouseholdCounts(std::string);
 	void outputPersonCounts(std::string);
 
-	void outputRiskFactorPercent();
+	void outputRiskFactorPercent(std::string);
 	void outputHealthOutcomes();
 	void outputCostEffectiveness();
 
@@ -136,12 +172,12 @@ private:
 	void initPtsdCounter();
 	void initTreatmentCounter(int);
 
-	void accumulateRiskFacs(CardioAgent *);
+	void accumulateRiskFacs(CardioAgent *, int);
 
 	void computePrevalence(int, int);
 	void computeRecovery(int, int);
 
-	void computeDALYs(AgentListPtr *);
+	void computeDALYs(const PtsdState *, const AgentIDs *);
 	void computeTotalCost();
 	void computeAverageCost();
 	
@@ -149,27 +185,35 @@ private:
 	Risk computeDiff(double *, double);
 	Risk computeRatio(double *, double);
 
-	void clearMap(TypeMap &);
+	int getYear(int) const;
+	int getRiskFactorCount(const std::string &) const;
+
+	void mergeOutcomes(const Counter &);
+
+	static void addAt(TickInts &, int, int);
+	static void mergeTicks(TickInts &, const TickInts &);
+	static void mergeTicks(TickDbls &, const TickDbls &);
 	void clearCounter();
 
 	std::shared_ptr<Parameters> parameters;
 
-	TypeMap m_personCount, m_householdCount;
+	TypeCounts m_personCount, m_householdCount;
 	
 	RiskFacMap m_sumRiskFac;
-	TypeMap m_riskFacCount;
+	TypeCounts m_riskFacCount;
 	
-	//Counters for Mass Violence Model(PTSD and PTSD resolved)
+	//Counters for Mass Violence Model(PTSD and PTSD resolved), indexed by tick
 	int nonPtsdCountSC;
-	MapInts m_ptsdCount[NUM_TREATMENT][NUM_PTSD], m_ptsdResolvedCount[NUM_TREATMENT][NUM_PTSD];
-	MapDbls m_totPrev[NUM_TREATMENT][NUM_PTSD], m_totRecovery[NUM_TREATMENT][NUM_PTSD];
+	TickInts m_ptsdCount[NUM_TREATMENT][NUM_PTSD], m_ptsdResolvedCount[NUM_TREATMENT][NUM_PTSD];
+	TickDbls m_totPrev[NUM_TREATMENT][NUM_PTSD], m_totRecovery[NUM_TREATMENT][NUM_PTSD];
 	
-	MapInts m_cbtReach[NUM_TREATMENT], m_sprReach[NUM_TREATMENT];
-	MapInts m_cbtCount, m_sprCount, m_ndCount; //overall count of CBT and SPR treatment
-	MapInts m_totCbt[NUM_TREATMENT][NUM_CASES], m_totSpr[NUM_TREATMENT][NUM_CASES];
+	TickInts m_cbtReach[NUM_TREATMENT], m_sprReach[NUM_TREATMENT];
+	TickInts m_cbtCount, m_sprCount, m_ndCount; //overall count of CBT and SPR treatment
+	TickInts m_totCbt[NUM_TREATMENT][NUM_CASES], m_totSpr[NUM_TREATMENT][NUM_CASES]; //indexed by year
 	
-	MapOutcomes m_prevalence, m_recovery;
-	MapDbls m_totDalys, m_totPtsdFreeWeeks, m_totCost, m_avgCost;
+	//outcomes accumulated over trials
+	TickOutcomes m_prevalence, m_recovery;
+	double m_totDalys[NUM_TREATMENT], m_totPtsdFreeWeeks[NUM_TREATMENT], m_totCost[NUM_TREATMENT], m_avgCost[NUM_TREATMENT];
 	
 
 };
@@ -0,0 +1,98 @@
+#include "FriendPool.h"
+#include "ViolenceAgent.h"
+#include "Random.h"
+
+FriendPool::FriendPool()
+{
+}
+
+FriendPool::~FriendPool()
+{
+}
+
+/**
+*	@param a is agent looking for friends
+*	@param group is matching group of the agent (origin or origin and education)
+*	@return void
+*/
+void FriendPool::insert(ViolenceAgent *a, int group)
+{
+	size_t id = (size_t)a->getAgentID();
+	if(id >= slots.size())
+	{
+		Slot empty = {-1, 0};
+		slots.resize(id+1, empty);
+	}
+
+	if(slots[id].group >= 0)
+		return;
+
+	Group &agents = groups[group];
+	slots[id].group = group;
+	slots[id].pos = agents.size();
+	agents.push_back(a);
+}
+
+/**
+*	@brief Removes an agent (e.g. once it has reached its friend size); the last
+*	agent of the group takes its position
+*	@param a is agent
+*	@return void
+*/
+void FriendPool::remove(const ViolenceAgent *a)
+{
+	size_t id = (size_t)a->getAgentID();
+	if(id >= slots.size() || slots[id].group < 0)
+		return;
+
+	Slot slot = slots[id];
+	slots[id].group = -1;
+
+	Group &agents = groups[slot.group];
+	if(slot.pos+1 < agents.size())
+	{
+		agents[slot.pos] = agents.back();
+		slots[agents[slot.pos]->getAgentID()].pos = slot.pos;
+	}
+	agents.pop_back();
+}
+
+void FriendPool::clear()
+{
+	groups.clear();
+	slots.clear();
+}
+
+/**
+*	@brief Draws an agent uniformly from a group
+*	@param group is matching group
+*	@param random is random number stream
+*	@return agent, or NULL if the group is empty
+*/
+ViolenceAgent * FriendPool::sample(int group, Random *random) const
+{
+	auto found = groups.find(group);
+	if(found == groups.end() || found->second.empty())
+		return NULL;
+
+	return found->second[random->random_int(0, (int)found->second.size()-1)];
+}
+
+/**
+*	@return number of agents of a group
+*/
+size_t FriendPool::size(int group) const
+{
+	auto found = groups.find(group);
+	return (found != groups.end()) ? found->second.size() : 0;
+}
+
+/**
+*	@param id is agent ID
+*	@param group is matching group
+*	@return true if the agent is in the group
+*/
+bool FriendPool::contains(int id, int group) const
+{
+	return id >= 0 && (size_t)id < slots.size() && slots[id].group == group;
+}
@@ -0,0 +1,48 @@
+#ifndef __FriendPool_h__
+#define __FriendPool_h__
+
+#include <cstddef>
+#include <vector>
+#include <map>
+
+class ViolenceAgent;
+class Random;
+
+/**
+*	@brief Index of agents still looking for friends, used to build the social
+*	network. Agents are kept in groups, where the group is origin (school networks)
+*	or origin and education (other agents), so that a candidate of a group is drawn
+*	uniformly in O(1) instead of shuffling the group. Agents that reach their friend
+*	size are removed in O(1) by swapping them with the last agent of their group;
+*	their positions are kept by agent ID.
+*/
+class FriendPool
+{
+public:
+	FriendPool();
+	virtual ~FriendPool();
+
+	void insert(ViolenceAgent *, int);
+	void remove(const ViolenceAgent *);
+	void clear();
+
+	ViolenceAgent *sample(int, Random *) const;
+
+	size_t size(int) const;
+	bool contains(int, int) const;
+
+private:
+	typedef std::vector<ViolenceAgent*> Group;
+
+	//position of an agent in the index (group -1: not in the pool)
+	struct Slot
+	{
+		int group;
+		size_t pos;
+	};
+
+	std::map<int, Group> groups;
+	std::vector<Slot> slots; //by agent ID
+};
+
+#endif __FriendPool_h__
@@ -122,6 +122,11 @@ std::vector<PersonPums> HouseholdPums::getPersons() const
 	return hhPersons;
 }
 
+const std::vector<PersonPums> & HouseholdPums::getPersonList() const
+{
+	return hhPersons;
+}
+
 void HouseholdPums::clearPersonList()
 {
 	hhPersons.clear();
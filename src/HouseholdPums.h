@@ -31,6 +31,7 @@ public:
 	short int getHouseholdIncCat() const;
 	short int getHHTypeBySize() const;
 	std::vector<PersonPums> getPersons() const;
+	const std::vector<PersonPums> &getPersonList() const;
 	void clearPersonList();
 	
 private:
@@ -1,5 +1,6 @@
 #include "IPU.h"
 #include "ACS.h"
+#include "StageCache.h"
 
 #define MAX_ITERATIONS 4000
 
@@ -20,6 +21,7 @@ void IPU::start()
 	solve(freqMatrix.n_rows, freqMatrix.n_cols);
 	computeProbabilities();
 	roundWeights(m_hhCount);
+	roundWeights(m_recordWeights);
 	clear();
 }
 
@@ -41,13 +43,111 @@ double IPU::getHHCount(std::string hhType) const
 		return -1;
 }
 
+/**
+*	@return integerized IPU weight of each refined PUMS household keyed by household index
+*/
+const IPU::WeightsMap *IPU::getHHWeights() const
+{
+	return &m_recordWeights;
+}
+
 void IPU::clearMap()
 {
 	m_hhCount.clear();
 	m_hhProbs.clear();
+	m_recordWeights.clear();
 	m_idx.clear();
 }
 
+/**
+*	@brief Writes IPU solution (household probabilities, counts and weights) to 
+*	the stage cache
+*	@param writer receives the solution
+*	@return void
+*/
+void IPU::save(CacheWriter &writer) const
+{
+	writer.put<int32_t>(ipu_success);
+
+	writer.put<uint64_t>(m_hhCount.size());
+	for(auto it = m_hhCount.begin(); it != m_hhCount.end(); ++it)
+	{
+		writer.putString(it->first);
+		writer.put<double>(it->second);
+	}
+
+	writer.put<uint64_t>(m_recordWeights.size());
+	for(auto it = m_recordWeights.begin(); it != m_recordWeights.end(); ++it)
+	{
+		writer.put<double>(it->first);
+		writer.put<double>(it->second);
+	}
+
+	writer.put<uint64_t>(m_hhProbs.size());
+	for(auto type = m_hhProbs.begin(); type != m_hhProbs.end(); ++type)
+	{
+		writer.putString(type->first);
+		writer.put<uint64_t>(type->second.size());
+		for(auto hash = type->second.begin(); hash != type->second.end(); ++hash)
+		{
+			writer.put<double>(hash->first);
+			writer.put<uint64_t>(hash->second.size());
+			for(auto pr = hash->second.begin(); pr != hash->second.end(); ++pr)
+			{
+				writer.put<double>(pr->first);
+				writer.put<double>(pr->second);
+			}
+		}
+	}
+}
+
+/**
+*	@brief Restores IPU solution written by save() instead of running IPU
+*	@param reader is cached solution
+*	@return false if the cached solution is incomplete
+*/
+bool IPU::load(CacheReader &reader)
+{
+	clearMap();
+	ipu_success = (reader.get<int32_t>() != 0);
+
+	uint64_t num_types = reader.get<uint64_t>();
+	for(uint64_t i = 0; i < num_types && reader.good(); ++i)
+	{
+		std::string type = reader.getString();
+		m_hhCount[type] = reader.get<double>();
+	}
+
+	uint64_t num_records = reader.get<uint64_t>();
+	for(uint64_t i = 0; i < num_records && reader.good(); ++i)
+	{
+		double hhIdx = reader.get<double>();
+		m_recordWeights[hhIdx] = reader.get<double>();
+	}
+
+	num_types = reader.get<uint64_t>();
+	for(uint64_t i = 0; i < num_types && reader.good(); ++i)
+	{
+		std::map<double, std::vector<PairDD>> &hashes = m_hhProbs[reader.getString()];
+		uint64_t num_hashes = reader.get<uint64_t>();
+		for(uint64_t j = 0; j < num_hashes && reader.good(); ++j)
+		{
+			std::vector<PairDD> &probs = hashes[reader.get<double>()];
+			uint64_t num_probs = reader.get<uint64_t>();
+			for(uint64_t k = 0; k < num_probs && reader.good(); ++k)
+			{
+				double prob = reader.get<double>();
+				probs.push_back(PairDD(prob, reader.get<double>()));
+			}
+		}
+	}
+
+	if(!reader.good())
+		clearMap();
+
+	return reader.good();
+}
+
 void IPU::initialize()
 {
 	int num_rows, num_cols;
@@ -333,6 +433,8 @@ void IPU::computeProbabilities()
 		for(auto wt = range.first; wt != range.second; ++wt)
 			wt->second.push_back(PairDD(weights(idx), hhIdx));
 
+		m_recordWeights.insert(std::make_pair(hhIdx, weights(idx)));
+
 		idx++;
 	}
 
@@ -415,6 +517,23 @@ void IPU::roundWeights(std::map<std::string, double> &m_hhCount)
 	}
 }
 
+void IPU::roundWeights(WeightsMap &m_weights)
+{
+	double adj = 0;
+	for(auto hh = m_weights.begin(); hh != m_weights.end(); ++hh)
+	{
+		 double diff = adj+(hh->second-floor(hh->second));
+		 if(diff >= 0.5){
+			 adj = diff-1;
+			 hh->second = ceil(hh->second);
+		 }
+		 else{
+			 adj = diff;
+			 hh->second = floor(hh->second);
+		 }
+	}
+}
+
 void IPU::clear()
 {
 	freqMatrix.clear();
@@ -14,6 +14,8 @@
 #include "PersonPums.h"
 
 //class HouseholdPums;
+class CacheWriter;
+class CacheReader;
 
 using namespace arma;
 
@@ -27,6 +29,7 @@ public:
 	typedef std::map<int, std::vector<int>> ColIndexMap;
 	typedef std::map<std::string, double> CountsMap;
 	typedef std::map<double, HouseholdPums> HouseholdsMap;
+	typedef std::map<double, double> WeightsMap;
 	//typedef std::unordered_map<double, HouseholdPums> HouseholdsMap;
 
 	IPU(HouseholdsMap *, const std::vector<double>&, bool);
@@ -37,7 +40,11 @@ public:
 	bool success();
 	const ProbMap *getHHProbability() const;
 	double getHHCount(std::string) const;
+	const WeightsMap *getHHWeights() const;
 	void clearMap();
+
+	void save(CacheWriter &) const;
+	bool load(CacheReader &);
 	
 private:
 
@@ -48,9 +55,10 @@ private:
 	double getColWeightSum(int);
 	void computeProbabilities();
 	void roundWeights(std::map<std::string, double> &);
+	void roundWeights(WeightsMap &);
 	void clear();
 
-	std::shared_ptr<HouseholdsMap> m_households;
+	HouseholdsMap *m_households; //owned by IPUWrapper
 	sp_mat freqMatrix;
 	vec cons;
 	vec weights;
@@ -63,6 +71,7 @@ private:
 	//ProbMap m_hhProbs;
 	ProbMap m_hhProbs;
 	CountsMap m_hhCount;
+	WeightsMap m_recordWeights;
 };
 
 #endif __IPU_h__
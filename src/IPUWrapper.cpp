@@ -16,7 +16,7 @@
 
 
 IPUWrapper::IPUWrapper(std::shared_ptr<Parameters>param, ACSEstimates *m_metroEst, CountyMap *mapCountyPuma) : 
-	parameters(param), m_metroACSEst(m_metroEst), m_pumaCounty(mapCountyPuma)
+	parameters(param), m_metroACSEst(m_metroEst), m_pumaCounty(mapCountyPuma), ipu(NULL), stageCache(NULL)
 {
 }
 
@@ -26,6 +26,19 @@ IPUWrapper::~IPUWrapper()
 }
 
 void IPUWrapper::startIPU(std::string metroID, int tot_pop, bool run)
+{
+	importPUMS(metroID, tot_pop);
+	solveIPU(run);
+}
+
+/**
+*	@brief Imports household and person PUMS of the states of the MSA (I/O bound
+*	stage of IPU, run ahead of solveIPU() by the metro pipeline)
+*	@param metroID is geoID of MSA
+*	@param tot_pop is total population of MSA
+*	@return void
+*/
+void IPUWrapper::importPUMS(std::string metroID, int tot_pop)
 {
 	this->geoID = metroID;
 	this->totalPop = tot_pop;
@@ -37,16 +50,52 @@ void IPUWrapper::startIPU(std::string metroID, int tot_pop, bool run)
 		importPersonPUMS(states[i]);
 	}
 
-	computeHouseholdEst();
-	computePersonEst();
+	if(stageCache != NULL)
+		pumsHash = getPumsHash();
+}
 
-	refineHHPumsList();
+/**
+*	@brief Computes IPF constraints from imported PUMS and runs IPU (CPU bound 
+*	stage of IPU)
+*	@param run is true to run IPU
+*	@return void
+*/
+void IPUWrapper::solveIPU(bool run)
+{
+	//each stage is keyed by its inputs and the key of the stage before it
+	StageHash ipfKey = getIPFKey();
+	if(!loadConstraints(ipfKey))
+	{
+		computeHouseholdEst();
+		computePersonEst();
+		saveConstraints(ipfKey);
+	}
+	else
+	{
+		m_pumsHHCount.clear();
+		m_pumsPerCount.clear();
+	}
+
+	StageHash refineKey("refine");
+	refineKey.add(ipfKey.value());
+	if(!loadRefinedList(refineKey))
+	{
+		refineHHPumsList();
+		saveRefinedList(refineKey);
+	}
+
+	solutionKey = StageHash("ipu");
+	solutionKey.add(refineKey.value());
 
 	std::cout << "Starting IPU...\n" << std::endl;
 
 	if(run){
 		ipu = new IPU(&m_householdPUMS, ipuCons, true);
-		ipu->start();
+		if(!loadSolution(solutionKey))
+		{
+			ipu->start();
+			saveSolution(solutionKey);
+		}
 	}
 	else{
 		std::cout << "Error: Cannot start IPU! " << std::endl;
@@ -76,11 +125,205 @@ double IPUWrapper::getHouseholdCount(std::string type) const
 	return ipu->getHHCount(type);
 }
 
+const IPUWrapper::WeightsMap * IPUWrapper::getHouseholdWeights() const
+{
+	return ipu->getHHWeights();
+}
+
 const IPUWrapper::Marginal * IPUWrapper::getConstraints() const
 {
 	return &ipuCons;
 }
 
+void IPUWrapper::setStageCache(StageCache *cache)
+{
+	stageCache = cache;
+}
+
+/**
+*	@return key of the IPU solution, which hashes all inputs of the IPU stages
+*/
+const StageHash &IPUWrapper::getSolutionKey() const
+{
+	return solutionKey;
+}
+
+/**
+*	@brief Hashes imported PUMS households and persons by the attributes used by 
+*	IPF, refinement and IPU
+*	@return hash of PUMS store of the MSA
+*/
+StageHash IPUWrapper::getPumsHash() const
+{
+	StageHash hash("pums");
+	for(auto hh = m_householdPUMS.begin(); hh != m_householdPUMS.end(); ++hh)
+	{
+		hash.add(hh->first);
+		hash.add(hh->second.getPUMA());
+		hash.add((int)hh->second.getHouseholdType());
+		hash.add((int)hh->second.getHouseholdSize());
+		hash.add((int)hh->second.getHouseholdIncCat());
+
+		const std::vector<PersonPums> &persons = hh->second.getPersonList();
+		hash.add((uint64_t)persons.size());
+		for(auto pp = persons.begin(); pp != persons.end(); ++pp)
+		{
+			hash.add(pp->getPUMSID());
+			hash.add((int)pp->getAge());
+			hash.add((int)pp->getAgeCat());
+			hash.add((int)pp->getEduAgeCat());
+			hash.add((int)pp->getSex());
+			hash.add((int)pp->getOrigin());
+			hash.add((int)pp->getEducation());
+		}
+	}
+	return hash;
+}
+
+/**
+*	@brief Hashes inputs of IPF: ACS marginal rows of the MSA, origin mapping,
+*	household and person pools and the PUMS store
+*	@return key of IPF constraint vector
+*/
+StageHash IPUWrapper::getIPFKey() const
+{
+	StageHash key("ipf");
+	key.add(geoID);
+	key.add(totalPop);
+	key.add(pumsHash.value());
+
+	for(auto est = m_metroACSEst->begin(); est != m_metroACSEst->end(); ++est)
+	{
+		auto msa = est->second.equal_range(geoID);
+		for(auto row = msa.first; row != msa.second; ++row)
+		{
+			key.add(est->first);
+			key.add((uint64_t)row->second.size());
+			for(auto col = row->second.begin(); col != row->second.end(); ++col)
+				key.add(*col);
+		}
+	}
+
+	std::map<std::string, int> origins = parameters->getOriginMapping();
+	for(auto org = origins.begin(); org != origins.end(); ++org)
+	{
+		key.add(org->first);
+		key.add(org->second);
+	}
+
+	const std::vector<std::string> *pools[2] = {parameters->getHouseholdPool(), parameters->getPersonPool()};
+	for(int i = 0; i < 2; ++i)
+	{
+		key.add((uint64_t)pools[i]->size());
+		for(auto type = pools[i]->begin(); type != pools[i]->end(); ++type)
+			key.add(*type);
+	}
+
+	return key;
+}
+
+bool IPUWrapper::loadConstraints(const StageHash &key)
+{
+	CacheReader reader;
+	if(stageCache == NULL || !stageCache->load(STAGE_IPF, key, reader))
+		return false;
+
+	Marginal cons(reader.get<uint64_t>());
+	for(size_t i = 0; i < cons.size() && reader.good(); ++i)
+		cons[i] = reader.get<double>();
+
+	if(!reader.good())
+		return false;
+
+	ipuCons = cons;
+	std::cout << "IPF constraints loaded from stage cache\n" << std::endl;
+	return true;
+}
+
+void IPUWrapper::saveConstraints(const StageHash &key)
+{
+	if(stageCache == NULL)
+		return;
+
+	CacheWriter writer;
+	writer.put<uint64_t>(ipuCons.size());
+	for(auto con = ipuCons.begin(); con != ipuCons.end(); ++con)
+		writer.put<double>(*con);
+
+	stageCache->save(STAGE_IPF, key, writer);
+}
+
+/**
+*	@brief Keeps households of the cached refined list. The list holds household
+*	indices in map order, so refinement is a single merge pass.
+*	@param key is key of refinement stage
+*	@return true if the refined list was loaded
+*/
+bool IPUWrapper::loadRefinedList(const StageHash &key)
+{
+	CacheReader reader;
+	if(stageCache == NULL || !stageCache->load(STAGE_REFINE, key, reader))
+		return false;
+
+	std::vector<double> kept(reader.get<uint64_t>());
+	for(size_t i = 0; i < kept.size() && reader.good(); ++i)
+		kept[i] = reader.get<double>();
+
+	if(!reader.good())
+		return false;
+
+	auto keep = kept.begin();
+	for(auto hh = m_householdPUMS.begin(); hh != m_householdPUMS.end();)
+	{
+		while(keep != kept.end() && *keep < hh->first)
+			++keep;
+
+		if(keep != kept.end() && *keep == hh->first)
+			++hh;
+		else
+			hh = m_householdPUMS.erase(hh);
+	}
+
+	std::cout << "PUMS households after refinement (stage cache): " << m_householdPUMS.size() << std::endl << std::endl;
+	return true;
+}
+
+void IPUWrapper::saveRefinedList(const StageHash &key)
+{
+	if(stageCache == NULL)
+		return;
+
+	CacheWriter writer;
+	writer.put<uint64_t>(m_householdPUMS.size());
+	for(auto hh = m_householdPUMS.begin(); hh != m_householdPUMS.end(); ++hh)
+		writer.put<double>(hh->first);
+
+	stageCache->save(STAGE_REFINE, key, writer);
+}
+
+bool IPUWrapper::loadSolution(const StageHash &key)
+{
+	CacheReader reader;
+	if(stageCache == NULL || !stageCache->load(STAGE_IPU, key, reader))
+		return false;
+
+	if(!ipu->load(reader))
+		return false;
+
+	std::cout << "IPU solution loaded from stage cache\n" << std::endl;
+	return true;
+}
+
+void IPUWrapper::saveSolution(const StageHash &key)
+{
+	if(stageCache == NULL)
+		return;
+
+	CacheWriter writer;
+	ipu->save(writer);
+	stageCache->save(STAGE_IPU, key, writer);
+}
+
 IPUWrapper::Columns IPUWrapper::getStateList()
 {
 	Columns states, tok;
@@ -11,6 +11,7 @@
 #include <map>
 #include "PersonPums.h"
 #include "HouseholdPums.h"
+#include "StageCache.h"
 
 class Parameters;
 class County;
@@ -31,18 +32,25 @@ public:
 	typedef std::map<double, HouseholdPums> HouseholdsMap;
 	typedef std::multimap<int, County> CountyMap;
 	typedef std::map<std::string, double> ConsPersonMap;
+	typedef std::map<double, double> WeightsMap;
 
 	IPUWrapper(std::shared_ptr<Parameters>, ACSEstimates*, CountyMap*);
 	virtual ~IPUWrapper();
 
 	void startIPU(std::string, int, bool);
+	void importPUMS(std::string, int);
+	void solveIPU(bool);
 	void clearHHPums();
 
 	bool successIPU();
 	const ProbMap *getHouseholdProbability() const;
 	const HouseholdsMap *getHouseholds() const;
 	double getHouseholdCount(std::string) const;
+	const WeightsMap *getHouseholdWeights() const;
 	const Marginal *getConstraints() const;
+
+	void setStageCache(StageCache *);
+	const StageHash &getSolutionKey() const;
 	
 
 private:
@@ -53,6 +61,15 @@ private:
 	void computeHouseholdEst();
 	void computePersonEst();
 	void refineHHPumsList();
+
+	StageHash getPumsHash() const;
+	StageHash getIPFKey() const;
+	bool loadConstraints(const StageHash &);
+	void saveConstraints(const StageHash &);
+	bool loadRefinedList(const StageHash &);
+	void saveRefinedList(const StageHash &);
+	bool loadSolution(const StageHash &);
+	void saveSolution(const StageHash &);
 	
 	Marginal getEstimatesVector(int, std::string);
 	void extractRaceEstimates(Marginal &, const std::map<int, std::vector<double>> &);
@@ -73,10 +90,12 @@ private:
 	int getCount(int, int, int, int, int, int);
 
 	std::shared_ptr<Parameters>parameters;
-	std::shared_ptr<ACSEstimates>m_metroACSEst;
-	std::shared_ptr<CountyMap> m_pumaCounty;
+	ACSEstimates *m_metroACSEst; //owned by Metro
+	CountyMap *m_pumaCounty; //owned by Metro
 	
 	IPU *ipu;
+	StageCache *stageCache; //owned by Metro, NULL: no caching
+	StageHash pumsHash, solutionKey;
 
 	std::string geoID;
 	int totalPop;
@@ -20,10 +20,15 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <map>
 #include "Parameters.h"
 #include "PopBrewer.h"
 #include "CardioModel.h"
 #include "ViolenceModel.h"
+#include "PopDaemon.h"
+#include "BatchRunner.h"
+#include "MultiModel.h"
+#include "RandomBenchmark.h"
 #include "csv.h"
 #include "IPU.h"
 #include "ACS.h"
@@ -39,19 +44,55 @@ int main(int argc, const char* argv[])
 	std::cout << std::endl;
 
 	std::vector<const char*> arguments;
+	std::map<std::string, std::string> options;
 	const int NUM_ARGUMENTS = 4;
 
-	if(argc < NUM_ARGUMENTS)
+	//positional arguments are followed by optional run options (--option=value)
+	for(int i = 0; i < argc; i++)
+	{
+		std::string arg(argv[i]);
+		if(arg.compare(0, 2, "--") == 0)
+		{
+			size_t eq = arg.find('=');
+			if(eq == std::string::npos)
+				options[arg.substr(2)] = "1";
+			else
+				options[arg.substr(2, eq-2)] = arg.substr(eq+1);
+		}
+		else
+		{
+			arguments.push_back(argv[i]);
+		}
+	}
+
+	if(arguments.size() < NUM_ARGUMENTS)
 	{
 		std::cout << "Program usage format\n";
-		std::cout << "Program name[Synthetic Pop] Input Directory[input] Output Directory[output] Simulation Type[MVS=2 or EET=1] Interactive[0 or 1]"
-			<< std::endl;
+		std::cout << "Program name[Synthetic Pop] Input Directory[input] Output Directory[output] Simulation Type[EET=1, MVS=2 or both=3] Interactive[0 or 1]"
+			<< " [--option=value ...]" << std::endl;
+		std::cout << "Options:\n";
+		std::cout << "  --population=expanded|weighted|streaming   draw individual agents (default), write weighted PUMS records" << std::endl;
+		std::cout << "                                             or draw agents PUMA by PUMA with bounded memory" << std::endl;
+		std::cout << "  --stream-sink=model|file                   hand streamed PUMAs to the model (default) or write them to agents/<msa>_agents.bin" << std::endl;
+		std::cout << "  --replicates=K                             draw K replicate populations from one IPU solution" << std::endl;
+		std::cout << "  --threads=N                                maximum number of worker threads (default: hardware threads)" << std::endl;
+		std::cout << "  --concurrent-trials=N                      maximum number of MVS trials run at once (default: one per thread)" << std::endl;
+		std::cout << "  --redraw-every=K                           MVS: draw population, school and network every K trials (0: once), restore them in between" << std::endl;
+		std::cout << "  --tick-order=tick|agent                    MVS: run all agents tick by tick (default) or blocks of agents through all ticks" << std::endl;
+		std::cout << "  --msa=all|ID[,ID...]                       MSAs to run (default: all MSAs for EET, 33100 for MVS)" << std::endl;
+		std::cout << "  --memory-budget=MB                         memory budget of concurrently running MSAs (default: unlimited)" << std::endl;
+		std::cout << "  --shard=i/N                                run shard i (0 <= i < N) of the MSA list, balanced by population" << std::endl;
+		std::cout << "  --merge-shards=N                           merge fit logs of N finished shards into gofLog.txt and exit" << std::endl;
+		std::cout << "  --pipeline[=D]                             overlap PUMS import, IPU and drawing of consecutive MSAs (queue depth D)" << std::endl;
+		std::cout << "  --seed=S                                   base seed of random number streams (default: 20170101)" << std::endl;
+		std::cout << "  --cache[=DIR]                              reuse IPF, IPU and draw results of unchanged inputs (default: <output>/cache/)" << std::endl;
+		std::cout << "  --daemon=PATH                              keep inputs loaded and serve population requests on Unix socket PATH" << std::endl;
+		std::cout << "  --manifest=FILE                            run the jobs listed in FILE in one process" << std::endl;
+		std::cout << "  --journal=FILE                             completion journal of --manifest (default: <output>/batch_journal.txt)" << std::endl;
+		std::cout << "  --benchmark-rng[=N]                        time N random variates per generator and distribution and exit" << std::endl;
 		exit(EXIT_SUCCESS);
 	}
 
-	for(int i = 0; i < argc; i++)
-		arguments.push_back(argv[i]);
-
 	int simType;
 	bool interactive = (std::stoi(arguments.back()) != 0) ? true : false;
 
@@ -59,15 +100,16 @@ int main(int argc, const char* argv[])
 	{
 		std::cout << "****Available simulation models****" << std::endl;
 		std::cout << "1. Equity Efficiency Model" << std::endl;
-		std::cout << "2. Mass Violence Model\n" << std::endl;
+		std::cout << "2. Mass Violence Model" << std::endl;
+		std::cout << "3. Both models on one population\n" << std::endl;
 
-		std::cout << "Please select simulation model (Enter 1 or 2) : ";
+		std::cout << "Please select simulation model (Enter 1, 2 or 3) : ";
 		std::cin >> simType; 
 
 		if(std::cin.eof())
 			exit(EXIT_SUCCESS);
 
-		while(!std::cin.eof() && !std::cin.good() || simType < EQUITY_EFFICIENCY || simType > MASS_VIOLENCE)
+		while(!std::cin.eof() && !std::cin.good() || simType < EQUITY_EFFICIENCY || simType > MULTI_MODEL)
 		{
 			std::cout << "Invalid input!" << std::endl;
 			std::cin.clear();
@@ -87,6 +129,58 @@ int main(int argc, const char* argv[])
 
 	std::cout << std::endl;
 	Parameters *param = new Parameters(arguments[1], arguments[2], simType);
+	param->setRunParams(&options);
+	std::cout << "Random seed: " << param->getRunParam()->seed << " (rerun with --seed=" << param->getRunParam()->seed << " to reproduce)\n" << std::endl;
+
+	if(options.count("benchmark-rng") > 0)
+	{
+		//"--benchmark-rng" alone times 10 million variates per case
+		const std::string &value = options["benchmark-rng"];
+		if(value.empty() || value.find_first_not_of("0123456789") != std::string::npos || std::strtoul(value.c_str(), NULL, 10) == 0)
+		{
+			std::cout << "Error: Invalid value of --benchmark-rng: " << value << "!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		size_t num = (value == "1") ? 10000000 : std::strtoul(value.c_str(), NULL, 10);
+		RandomBenchmark::run(param->getRunParam()->seed, num);
+		delete param;
+		return 0;
+	}
+
+	if(param->getRunParam()->merge_shards > 0)
+	{
+		PopBrewer::mergeShards(param);
+		delete param;
+		return 0;
+	}
+	
+	if(options.count("manifest") > 0)
+	{
+		std::string journal = (options.count("journal") > 0) ? options["journal"] : param->getOutputDir()+"batch_journal.txt";
+		BatchRunner *batch = new BatchRunner;
+
+		batch->setParameters(*param);
+		batch->import();
+		batch->run(options["manifest"], journal);
+
+		delete batch;
+		delete param;
+		return 0;
+	}
+
+	if(options.count("daemon") > 0)
+	{
+		PopDaemon *daemon = new PopDaemon;
+
+		daemon->setParameters(*param);
+		daemon->import();
+		daemon->serve(options["daemon"]);
+
+		delete daemon;
+		delete param;
+		return 0;
+	}
 	
 	switch(param->getSimType())
 	{
@@ -113,6 +207,18 @@ int main(int argc, const char* argv[])
 			delete massViolence;
 			break;
 		}
+
+	case MULTI_MODEL:
+		{
+			MultiModel *multiModel = new MultiModel;
+
+			multiModel->setParameters(*param);
+			multiModel->import();
+			multiModel->start();
+
+			delete multiModel;
+			break;
+		}
 	default:
 		break;
 	}
@@ -21,16 +21,27 @@
 #include "Random.h"
 #include "CardioModel.h"
 #include "ViolenceModel.h"
+#include "AgentSink.h"
+#include "StageCache.h"
 
 
 template void Metro::createAgents<CardioModel>(CardioModel *);
+template void Metro::createAgents<CardioModel>(CardioModel *, Random &);
 template void Metro::createAgents<ViolenceModel>(ViolenceModel *);
-
-Metro::Metro()
+template void Metro::createAgents<ViolenceModel>(ViolenceModel *, Random &);
+template void Metro::createAgents<ViolenceModel>(ViolenceModel *, Random &, int);
+template void Metro::createAgents<CardioModel, ViolenceModel>(CardioModel *, ViolenceModel *, Random &, int);
+template void Metro::generateAgents<CountSink>(CountSink *);
+template void Metro::generateAgents<CountSink>(CountSink *, Random &);
+template void Metro::generateAgents<BinaryFileSink>(BinaryFileSink *);
+template void Metro::generateAgents<BinaryFileSink>(BinaryFileSink *, Random &);
+
+Metro::Metro() : ipuWrapper(NULL), ipuSolved(false), gofLock(std::make_shared<std::mutex>())
 {
 }
 
-Metro::Metro(std::shared_ptr<Parameters>param) : parameters(param), ipuWrapper(NULL)
+Metro::Metro(std::shared_ptr<Parameters>param) : parameters(param), ipuWrapper(NULL), ipuSolved(false), 
+	gofLock(std::make_shared<std::mutex>())
 {
 	
 }
@@ -116,28 +127,234 @@ int Metro::getCountyNum(std::string countyName) const
 	return count;
 }
 
+/**
+*	@brief Draws households for a simulation model. The model receives households
+*	and persons accepted by its compile-time filter T::Filter (see AgentFilter.h)
+*	through ModelSink. With "--population=streaming --stream-sink=file" persons are
+*	written to agents/<geoID>_agents.bin instead.
+*	@param model is the simulation model receiving drawn households and persons
+*	@return void
+*/
 template <class T>
 void Metro::createAgents(T *model)
 {
-	if(ipuWrapper == NULL)
+	Random random(model->getParameters()->getRunParam()->seed, geoID, 0, RNG_PHASE_DRAW);
+	createAgents(model, random);
+}
+
+template <class T>
+void Metro::createAgents(T *model, Random &random)
+{
+	createAgents(model, random, NO_REPLICATE);
+}
+
+/**
+*	@brief Draws households for a simulation model with the draw's fit record tagged
+*	by the trial, so that concurrent trials are logged in trial order
+*	@param model is the simulation model receiving drawn households and persons
+*	@param random is random number stream of the draw
+*	@param trial is trial number logged with the fit, or NO_REPLICATE
+*	@return void
+*/
+template <class T>
+void Metro::createAgents(T *model, Random &random, int trial)
+{
+	runIPU();
+
+	const RunParams *runParam = model->getParameters()->getRunParam();
+	if(runParam->pop_mode == POP_STREAMING && runParam->stream_sink == STREAM_TO_FILE)
 	{
-		bool run = true;
-		IPUWrapper *ipuWrap = new IPUWrapper(parameters, &m_metroACSEst, &m_pumaCounty);
-		ipuWrap->startIPU(geoID, population, run);
-	
-		ipuWrapper = ipuWrap;
-		if(!ipuWrap->successIPU())
+		BinaryFileSink sink(model->getCounter(), model->getParameters()->getOutputDir()+"agents/"+geoID+"_agents.bin");
+		generateAgents(&sink, random, trial);
+	}
+	else
+	{
+		ModelSink<T> sink(model);
+		generateAgents(&sink, random, trial);
+	}
+
+	printCacheReport();
+}
+
+/**
+*	@brief Draws households once for two simulation models. Every drawn record is
+*	handed to both models (each through its own ModelSink and filter), so each
+*	model fills its own population and counter from the same draw. Persons are
+*	always handed to the models, also with "--stream-sink=file".
+*	@param model is first simulation model (its counter is used for the fit check)
+*	@param other is second simulation model
+*	@param random is random number stream of the draw
+*	@param trial is trial number logged with the fit, or NO_REPLICATE
+*	@return void
+*/
+template <class T, class U>
+void Metro::createAgents(T *model, U *other, Random &random, int trial)
+{
+	runIPU();
+
+	ModelSink<T> first(model);
+	ModelSink<U> second(other);
+
+	FanOutSink<ModelSink<T>, ModelSink<U>> sink(&first, &second);
+	generateAgents(&sink, random, trial);
+
+	printCacheReport();
+}
+
+/**
+*	@brief Runs IPU (once per MSA) and emits the synthetic population of the MSA
+*	to a sink (see AgentSink.h) according to the population mode. Fit of the draw
+*	is recorded and written to the fit log by writeGofLog().
+*	@param sink receives drawn households and persons
+*	@return void
+*/
+template <class Sink>
+void Metro::generateAgents(Sink *sink)
+{
+	Random random(parameters->getRunParam()->seed, geoID, 0, RNG_PHASE_DRAW);
+	generateAgents(sink, random);
+}
+
+template <class Sink>
+void Metro::generateAgents(Sink *sink, Random &random)
+{
+	runIPU();
+	generateAgents(sink, random, NO_REPLICATE);
+	printCacheReport();
+}
+
+bool Metro::isIPUSolved() const
+{
+	return ipuSolved;
+}
+
+template <class Sink>
+void Metro::generateAgents(Sink *sink, Random &random, int replicate)
+{
+	if(parameters->getRunParam()->pop_mode == POP_WEIGHTED)
+		writeWeightedRecords(ipuWrapper, sink, replicate);
+	else if(parameters->getRunParam()->pop_mode == POP_STREAMING)
+		streamHouseholds(ipuWrapper, sink, random, replicate);
+	else
+		drawHouseholds(ipuWrapper, sink, random, replicate);
+
+	sink->finish();
+}
+
+/**
+*	@brief Runs IPU of the MSA, unless it has already been run. The IPU solution
+*	(household probabilities and counts) is kept and shared by all later draws.
+*	@return void
+*/
+void Metro::runIPU()
+{
+	importPUMS();
+	solveIPU();
+}
+
+/**
+*	@brief Imports PUMS records of the MSA, unless already imported
+*	@return void
+*/
+void Metro::importPUMS()
+{
+	if(ipuWrapper != NULL)
+		return;
+
+	const std::string &cacheDir = parameters->getRunParam()->cache_dir;
+	if(stageCache == NULL && !cacheDir.empty())
+		stageCache = std::make_shared<StageCache>(cacheDir, geoID);
+
+	ipuWrapper = new IPUWrapper(parameters, &m_metroACSEst, &m_pumaCounty);
+	ipuWrapper->setStageCache(stageCache.get());
+	ipuWrapper->importPUMS(geoID, population);
+}
+
+/**
+*	@brief Runs IPU on imported PUMS records, unless already solved
+*	@return void
+*/
+void Metro::solveIPU()
+{
+	importPUMS();
+	if(ipuSolved)
+		return;
+
+	bool run = true;
+	ipuWrapper->solveIPU(run);
+	ipuSolved = true;
+
+	if(!ipuWrapper->successIPU())
+	{
+		std::cout << "IPU unsuccessful! Cannot Create Households!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+}
+
+/**
+*	@brief Generates K replicate populations of the MSA from a single IPU solution.
+*	Replicates share the (read-only) household sampler tables of the IPU solution, 
+*	while each replicate draws with its own random stream (base seed, replicate id)
+*	into its own counter. Replicates run in parallel on up to "--threads" workers.
+*	Persons of replicate k are written to agents/<geoID>_rep<k>.bin, household and
+*	person counts to households/ and persons/ (if output is enabled), and its fit
+*	is recorded tagged with the replicate id (see writeGofLog()).
+*	@param num_replicates is number of replicate populations
+*	@return void
+*/
+void Metro::generateReplicates(int num_replicates)
+{
+	if(parameters->getRunParam()->pop_mode == POP_WEIGHTED)
+	{
+		std::cout << "Error: Replicates cannot be drawn in weighted population mode!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	runIPU();
+
+	int num_threads = parameters->getRunParam()->num_threads;
+	if(num_threads == 0)
+		num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+	num_threads = std::min(num_threads, num_replicates);
+
+	std::cout << "Generating " << num_replicates << " replicates of " << metroName 
+		<< " on " << num_threads << " threads...\n" << std::endl;
+
+	std::atomic<int> nextReplicate(0);
+	auto worker = [&]()
+	{
+		int rep;
+		while((rep = nextReplicate++) < num_replicates)
 		{
-			std::cout << "IPU unsuccessful! Cannot Create Households!" << std::endl;
-			exit(EXIT_SUCCESS);
+			std::string tag = geoID + "_rep" + std::to_string(rep);
+
+			Counter counter(parameters);
+			Random random(parameters->getRunParam()->seed, geoID, (uint32_t)rep+1, RNG_PHASE_DRAW);
+			BinaryFileSink sink(&counter, parameters->getOutputDir()+"agents/"+tag+".bin");
+
+			generateAgents(&sink, random, rep);
+
+			if(parameters->writeToFile())
+			{
+				counter.outputHouseholdCounts(tag);
+				counter.outputPersonCounts(tag);
+			}
 		}
-	}
-	
-	drawHouseholds(ipuWrapper, model);
+	};
+
+	std::vector<std::thread> workers;
+	for(int i = 0; i < num_threads; ++i)
+		workers.push_back(std::thread(worker));
+
+	for(auto t = workers.begin(); t != workers.end(); ++t)
+		t->join();
+
+	std::cout << "Replicates successfully generated!\n" << std::endl;
+	printCacheReport();
 }
 
-template <class T>
-void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
+template <class Sink>
+void Metro::drawHouseholds(IPUWrapper *ipuWrap, Sink *sink, Random &random, int replicate)
 {
 	std::cout << "Creating Households...\n" << std::endl;
 
@@ -150,24 +367,34 @@ void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
 
 	double num_households, randomP, hhProb, hhIdx;
 	std::string hhType;
+	std::vector<double> uniforms;
+
+	//accepted draw is keyed by IPU solution, fit test settings and generator state
+	StageHash drawKey("draw");
+	std::vector<std::pair<std::string, std::vector<double>>> drawnHH;
+	if(stageCache != NULL)
+	{
+		drawKey.add(ipuWrap->getSolutionKey().value());
+		drawKey.add(random.getState());
+		drawKey.add(parameters->getAlpha());
+		drawKey.add(parameters->getMinSampleSize());
+		drawKey.add(parameters->getMaxDraws());
+
+		CacheReader reader;
+		if(stageCache->load(STAGE_DRAW, drawKey, reader) && replayHouseholds(ipuWrap, sink, random, replicate, reader))
+			return;
+	}
 
 	bool fit_pop = false;
 	int num_draws = 0;
-	
-	std::vector<PersonPums> tempPersons;
-
-	std::string sex, ageCat, origin, eduAgeCat, edu;
-	std::string personType1, personType2;
-	std::string dummy = "0";
-
-	Random random;
 
 	while(!fit_pop)
 	{
 		int countHH = 0; int countPer = 0; 
+		drawnHH.clear();
 		
-		model->setSize(population);
-		model->getCounter()->initialize();
+		sink->reserve(population);
+		sink->begin();
 	
 		std::cout << "Drawing households - Attempt: " << ++num_draws << std::endl;
 
@@ -175,9 +402,22 @@ void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
 		{
 			hhType = hh->first;
 			num_households = ipuWrap->getHouseholdCount(hhType);
+			if(stageCache != NULL)
+				drawnHH.push_back(std::make_pair(hhType, std::vector<double>()));
+
+			//uniforms are generated in bulk, at most as many as households still to draw
+			uniforms.clear();
+			size_t next = 0;
 			while(num_households != 0)
 			{
-				randomP = random.uniform_real_dist();
+				if(next == uniforms.size())
+				{
+					uniforms.resize((size_t)num_households);
+					random.fill_uniform(uniforms.data(), uniforms.size());
+					next = 0;
+				}
+
+				randomP = uniforms[next++];
 				for(auto hash = hh->second.begin(); hash != hh->second.end(); ++hash)
 				{
 					PairDD last_elem = hash->second.back();
@@ -193,36 +433,16 @@ void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
 							if(randomP < hhProb)
 							{
 								countHH++;
-								model->getCounter()->addHouseholdCount(hhType);
 
 								const HouseholdPums *hh = &m_householdsPums->at(hhIdx);
+								const std::vector<PersonPums> &tempPersons = hh->getPersonList();
 
-								if(parameters->getSimType() == MASS_VIOLENCE)
-									model->addHousehold(hh, countHH);
+								sink->onHousehold(hhType, hh, countHH, 1);
+								sink->onPersonBatch(tempPersons.data(), tempPersons.size(), countHH, 1);
+								countPer += tempPersons.size();
 
-								tempPersons = hh->getPersons();
-								for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
-								{
-									sex = std::to_string(pp->getSex());
-									origin = std::to_string(pp->getOrigin());
-									ageCat = std::to_string(pp->getAgeCat());
-
-									personType1 = dummy+sex+ageCat+origin;
-									model->getCounter()->addPersonCount(personType1);
-			
-									if(pp->getAge() >= 18) 
-									{
-										eduAgeCat = std::to_string(pp->getEduAgeCat());
-										edu = std::to_string(pp->getEducation());
-
-										personType2 = sex+eduAgeCat+origin+edu;
-										model->getCounter()->addPersonCount(personType2);
-									}
-
-									countPer++;
-									if(parameters->getSimType() == EQUITY_EFFICIENCY)
-										model->addAgent(&(*pp));
-								}
+								if(stageCache != NULL)
+									drawnHH.back().second.push_back(hhIdx);
 
 								timer.stop();
 								if(timer.elapsed_ms() > waitTime)
@@ -243,9 +463,25 @@ void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
 
 		std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
 
-		fit_pop = checkFit(ipuCons, model->getCounter(), num_draws);
+		fit_pop = checkFit(ipuCons, sink->getCounter(), num_draws, replicate);
 		if(!fit_pop)
-			model->clearList();
+			sink->discard();
+	}
+
+	if(stageCache != NULL)
+	{
+		CacheWriter writer;
+		writer.put<int32_t>(num_draws);
+		writer.putString(random.getState());
+		writer.put<uint64_t>(drawnHH.size());
+		for(auto type = drawnHH.begin(); type != drawnHH.end(); ++type)
+		{
+			writer.putString(type->first);
+			writer.put<uint64_t>(type->second.size());
+			for(auto idx = type->second.begin(); idx != type->second.end(); ++idx)
+				writer.put<double>(*idx);
+		}
+		stageCache->save(STAGE_DRAW, drawKey, writer);
 	}
 
 	std::cout << "Households successfully created!\n" << std::endl;
@@ -253,11 +489,438 @@ void Metro::drawHouseholds(IPUWrapper *ipuWrap, T *model)
 	//ipuWrap->clearHHPums();
 }
 
-bool Metro::checkFit(const Marginal *cons, const Counter *count, int num_draws)
+/**
+*	@brief Emits the accepted draw of the stage cache instead of drawing again. The
+*	generator is left in the state it had after the original draw, so that later
+*	draws from the same stream are unchanged.
+*	@param ipuWrap is IPU solution of the MSA
+*	@param sink receives drawn households and persons
+*	@param random is random number stream of the draw
+*	@param replicate is replicate id logged with the fit
+*	@param reader is cached draw
+*	@return false if the cached draw is incomplete or refers to unknown households
+*/
+template <class Sink>
+bool Metro::replayHouseholds(IPUWrapper *ipuWrap, Sink *sink, Random &random, int replicate, CacheReader &reader)
 {
-	std::vector<double> obsFreq, estFreq;
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+
+	int num_draws = reader.get<int32_t>();
+	std::string rngState = reader.getString();
+
+	std::vector<std::pair<std::string, std::vector<double>>> drawnHH(reader.get<uint64_t>());
+	for(auto type = drawnHH.begin(); type != drawnHH.end() && reader.good(); ++type)
+	{
+		type->first = reader.getString();
+		type->second.resize(reader.get<uint64_t>());
+		for(size_t i = 0; i < type->second.size() && reader.good(); ++i)
+		{
+			type->second[i] = reader.get<double>();
+			if(m_householdsPums->count(type->second[i]) == 0)
+				return false;
+		}
+	}
+
+	if(!reader.good())
+		return false;
+
+	std::cout << "Replaying accepted draw from stage cache...\n" << std::endl;
+
+	sink->reserve(population);
+	sink->begin();
+
+	int countHH = 0; int countPer = 0;
+	for(auto type = drawnHH.begin(); type != drawnHH.end(); ++type)
+	{
+		for(auto idx = type->second.begin(); idx != type->second.end(); ++idx)
+		{
+			countHH++;
+
+			const HouseholdPums *hh = &m_householdsPums->at(*idx);
+			const std::vector<PersonPums> &persons = hh->getPersonList();
+
+			sink->onHousehold(type->first, hh, countHH, 1);
+			sink->onPersonBatch(persons.data(), persons.size(), countHH, 1);
+			countPer += persons.size();
+		}
+	}
+
+	std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+	checkFit(ipuWrap->getConstraints(), sink->getCounter(), num_draws, replicate);
+	random.setState(rngState);
+
+	std::cout << "Households successfully created!\n" << std::endl;
+	return true;
+}
+
+/**
+*	@brief Writes refined PUMS households and their persons with integerized IPU 
+*	weights as weighted microdata instead of expanding weights into individual
+*	draws. Counters and the model consume the weights directly, so memory and 
+*	runtime scale with the number of PUMS records rather than MSA population.
+*	@param ipuWrap is IPU solution of the MSA
+*	@param sink receives weighted households and persons
+*	@param replicate is replicate id logged with the fit
+*	@return void
+*/
+template <class Sink>
+void Metro::writeWeightedRecords(IPUWrapper *ipuWrap, Sink *sink, int replicate)
+{
+	std::cout << "Writing weighted PUMS records...\n" << std::endl;
+
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+	const WeightsMap *m_weights = ipuWrap->getHouseholdWeights();
+	const Marginal *ipuCons = ipuWrap->getConstraints();
+
+	std::ofstream hhFile, pFile;
+	std::string hhFileName = "weighted/" + geoID + "_households.csv";
+	std::string pFileName = "weighted/" + geoID + "_persons.csv";
+
+	Parameters::createDirectory(parameters->getOutputDir()+"weighted/");
+	hhFile.open(parameters->getOutputDir()+hhFileName);
+	pFile.open(parameters->getOutputDir()+pFileName);
+
+	if(!hhFile.is_open() || !pFile.is_open())
+	{
+		std::cout << "Error: Cannot create weighted microdata files for " << geoID << "!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	hhFile << "SERIALNO,PUMA,HHT,NP,HINC_CAT,WEIGHT" << std::endl;
+	pFile << "SERIALNO,AGEP,SEX,ORIGIN,SCHL,WEIGHT" << std::endl;
+
+	size_t num_records = 0;
+	for(auto hh = m_householdsPums->begin(); hh != m_householdsPums->end(); ++hh)
+		num_records += hh->second.getPersonList().size();
+
+	sink->reserve(num_records);
+	sink->begin();
+
+	std::string hhType;
+
+	int countHH = 0; int countPer = 0;
+	for(auto hh = m_householdsPums->begin(); hh != m_householdsPums->end(); ++hh)
+	{
+		int weight = (m_weights->count(hh->first) > 0) ? (int)m_weights->at(hh->first) : 0;
+		if(weight <= 0)
+			continue;
+
+		const HouseholdPums *household = &hh->second;
+		hhType = std::to_string(household->getHouseholdType())+std::to_string(household->getHouseholdSize())
+			+std::to_string(household->getHouseholdIncCat());
+
+		hhFile << std::setprecision(15) << household->getHouseholdIndex() << "," << household->getPUMA() << "," 
+			<< household->getHouseholdType() << "," << household->getHouseholdSize() << "," 
+			<< household->getHouseholdIncCat() << "," << weight << std::endl;
+
+		const std::vector<PersonPums> &persons = household->getPersonList();
+		for(auto pp = persons.begin(); pp != persons.end(); ++pp)
+		{
+			pFile << std::setprecision(15) << household->getHouseholdIndex() << "," << pp->getAge() << "," << pp->getSex() << "," 
+				<< pp->getOrigin() << "," << pp->getEducation() << "," << weight << std::endl;
+		}
+
+		countHH += weight;
+		countPer += weight*persons.size();
+
+		sink->onHousehold(hhType, household, countHH, weight);
+		sink->onPersonBatch(persons.data(), persons.size(), countHH, weight);
+	}
+
+	hhFile.close();
+	pFile.close();
+
+	std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+	//weighted records are a single draw; a failing fit is logged as failed
+	int df = 0;
+	double p_val = getFitPValue(ipuCons, sink->getCounter(), df);
+	gofLog(p_val, df, 1, replicate, p_val > parameters->getAlpha());
+
+	std::cout << "Weighted records successfully written!\n" << std::endl;
+}
+
+/**
+*	@brief Draws and emits households one PUMA at a time. Household counts by type
+*	are split by population shares across the PUMAs that have PUMS records of the 
+*	type, and households of a PUMA are drawn from the IPU probabilities restricted
+*	to PUMS records of that PUMA. Types with records in none of the PUMAs are drawn
+*	from MSA probabilities and reported as cross-PUMA draws. Each
+*	PUMA is flushed to the sink before the next PUMA is drawn, so that peak memory
+*	is bounded by the largest PUMA instead of the whole MSA. As in drawHouseholds(),
+*	a draw rejected by the goodness-of-fit check is discarded by the sink and
+*	streamed again, up to the maximum number of draws.
+*	@param ipuWrap is IPU solution of the MSA
+*	@param sink receives streamed households and persons
+*	@param random is random number stream of the draw
+*	@param replicate is replicate id logged with the fit
+*	@return void
+*/
+template <class Sink>
+void Metro::streamHouseholds(IPUWrapper *ipuWrap, Sink *sink, Random &random, int replicate)
+{
+	std::cout << "Streaming households by PUMA...\n" << std::endl;
+
+	const ProbMap *prHouseholds = ipuWrap->getHouseholdProbability();
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+	const Marginal *ipuCons = ipuWrap->getConstraints();
+
+	//flattens bucketed household probabilities of MSA into one cumulative list per household type
+	SamplerMap metroSampler;
+	for(auto hh = prHouseholds->begin(); hh != prHouseholds->end(); ++hh)
+	{
+		Sampler flat;
+		for(auto hash = hh->second.begin(); hash != hh->second.end(); ++hash)
+			flat.insert(flat.end(), hash->second.begin(), hash->second.end());
+
+		metroSampler.insert(std::make_pair(hh->first, flat));
+	}
+
+	std::map<int, double> pumaShares = getPumaShares();
+	std::map<std::string, std::map<int, double>> typeShares = getPumaTypeShares(metroSampler, m_householdsPums, pumaShares);
+	std::map<std::string, double> adjByType;
+
+	std::string hhType;
+	std::vector<double> uniforms;
+
+	bool fit_pop = false;
+	int num_draws = 0;
+
+	while(!fit_pop)
+	{
+		int countHH = 0; int countPer = 0;
+		int crossPuma = 0;
+		adjByType.clear();
+
+		sink->begin();
+
+		std::cout << "Streaming households - Attempt: " << ++num_draws << std::endl;
+
+		for(auto puma = pumaShares.begin(); puma != pumaShares.end(); ++puma)
+		{
+			SamplerMap pumaSampler = getPumaSampler(metroSampler, m_householdsPums, puma->first);
+
+			//draws household indices of current PUMA first, so that the sink can size its containers
+			std::vector<std::pair<std::string, double>> drawnHH;
+			size_t num_persons = 0;
+			for(auto type = metroSampler.begin(); type != metroSampler.end(); ++type)
+			{
+				hhType = type->first;
+
+				//households of a type are drawn in the PUMAs that have records of the type
+				auto shares = typeShares.find(hhType);
+				bool local = (shares != typeShares.end());
+				double share = puma->second;
+				if(local)
+					share = (shares->second.count(puma->first) > 0) ? shares->second.at(puma->first) : 0.0;
+
+				//splits MSA household count across PUMAs with carry-over rounding
+				double adj = adjByType[hhType];
+				double expected = ipuWrap->getHouseholdCount(hhType)*share;
+				double diff = adj+(expected-floor(expected));
+				int num_households = (diff >= 0.5) ? (int)ceil(expected) : (int)floor(expected);
+				adjByType[hhType] = (diff >= 0.5) ? diff-1 : diff;
+
+				if(num_households <= 0)
+					continue;
+
+				const Sampler *sampler = local ? &pumaSampler.at(hhType) : &type->second;
+				if(sampler->empty())
+					continue;
+
+				if(!local)
+					crossPuma += num_households;
+
+				double maxProb = sampler->back().first;
+				uniforms.resize(std::max(num_households, 0));
+				random.fill_uniform(uniforms.data(), uniforms.size());
+
+				for(int i = 0; i < num_households; ++i)
+				{
+					double randomP = maxProb*uniforms[i];
+					auto pick = std::upper_bound(sampler->begin(), sampler->end(), PairDD(randomP, -1.0));
+					if(pick == sampler->end())
+						--pick;
+
+					drawnHH.push_back(std::make_pair(hhType, pick->second));
+					num_persons += m_householdsPums->at(pick->second).getPersonList().size();
+				}
+			}
+
+			sink->reserve(num_persons);
+
+			for(auto drawn = drawnHH.begin(); drawn != drawnHH.end(); ++drawn)
+			{
+				countHH++;
+
+				const HouseholdPums *hh = &m_householdsPums->at(drawn->second);
+				const std::vector<PersonPums> &persons = hh->getPersonList();
+
+				sink->onHousehold(drawn->first, hh, countHH, 1);
+				sink->onPersonBatch(persons.data(), persons.size(), countHH, 1);
+				countPer += persons.size();
+			}
+
+			std::cout << "PUMA: " << puma->first << " Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+			//current PUMA is released by the sink before next PUMA is drawn
+			sink->flush(puma->first);
+		}
+
+		std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+		if(crossPuma > 0)
+			std::cout << "Households drawn from PUMS records of other PUMAs: " << crossPuma << std::endl;
+
+		fit_pop = checkFit(ipuCons, sink->getCounter(), num_draws, replicate);
+		if(!fit_pop)
+			sink->discard();
+	}
+
+	std::cout << "Households successfully streamed!\n" << std::endl;
+}
+
+/**
+*	@brief Computes share of MSA population in each PUMA. A PUMA's weight is the
+*	sum of population weights of its counties that lie in the MSA, as PUMAs are 
+*	delineated to have roughly equal population.
+*	@return map paired with PUMA code and its normalized population share
+*/
+std::map<int, double> Metro::getPumaShares() const
+{
+	std::map<int, double> shares;
+	double sum_weights = 0;
+	for(auto cnty = m_pumaCounty.begin(); cnty != m_pumaCounty.end(); ++cnty)
+	{
+		shares[cnty->first] += cnty->second.getPopulationWeight();
+		sum_weights += cnty->second.getPopulationWeight();
+	}
+
+	for(auto it = shares.begin(); it != shares.end(); ++it)
+		it->second = (sum_weights > 0) ? it->second/sum_weights : 0.0;
+
+	return shares;
+}
+
+/**
+*	@brief Splits each household type across the PUMAs that have PUMS records of
+*	the type, renormalizing their population shares. Types without records in any
+*	PUMA of the MSA are left out.
+*	@param metroSampler is cumulative household probabilities by household type
+*	@param m_householdsPums is list of refined PUMS households
+*	@param pumaShares is population share of each PUMA
+*	@return map paired with household type and its shares by PUMA code
+*/
+std::map<std::string, std::map<int, double>> Metro::getPumaTypeShares(const SamplerMap &metroSampler, 
+	const PUMSHouseholdsMap *m_householdsPums, const std::map<int, double> &pumaShares) const
+{
+	std::map<std::string, std::map<int, double>> typeShares;
+	for(auto type = metroSampler.begin(); type != metroSampler.end(); ++type)
+	{
+		std::map<int, double> shares;
+		double sum_shares = 0;
+		double prevProb = 0;
+		for(auto pr = type->second.begin(); pr != type->second.end(); ++pr)
+		{
+			double prob = pr->first-prevProb;
+			prevProb = pr->first;
+			if(prob <= 0)
+				continue;
+
+			int puma = m_householdsPums->at(pr->second).getPUMA();
+			auto share = pumaShares.find(puma);
+			if(share != pumaShares.end() && share->second > 0 && shares.count(puma) == 0)
+			{
+				shares[puma] = share->second;
+				sum_shares += share->second;
+			}
+		}
+
+		if(sum_shares <= 0)
+			continue;
+
+		for(auto it = shares.begin(); it != shares.end(); ++it)
+			it->second /= sum_shares;
+
+		typeShares.insert(std::make_pair(type->first, shares));
+	}
+
+	return typeShares;
+}
+
+/**
+*	@brief Restricts cumulative household probabilities of MSA to PUMS households of
+*	a PUMA. Household types without PUMS records in the PUMA are left out.
+*	@param metroSampler is cumulative household probabilities by household type
+*	@param m_householdsPums is list of refined PUMS households
+*	@param puma is PUMA code
+*	@return cumulative (unnormalized) household probabilities of PUMA by household type
+*/
+Metro::SamplerMap Metro::getPumaSampler(const SamplerMap &metroSampler, const PUMSHouseholdsMap *m_householdsPums, int puma) const
+{
+	SamplerMap pumaSampler;
+	for(auto type = metroSampler.begin(); type != metroSampler.end(); ++type)
+	{
+		Sampler sampler;
+		double prevProb = 0;
+		double cumProb = 0;
+		for(auto pr = type->second.begin(); pr != type->second.end(); ++pr)
+		{
+			double prob = pr->first-prevProb;
+			prevProb = pr->first;
+
+			if(prob > 0 && m_householdsPums->at(pr->second).getPUMA() == puma)
+			{
+				cumProb += prob;
+				sampler.push_back(PairDD(cumProb, pr->second));
+			}
+		}
+
+		if(!sampler.empty())
+			pumaSampler.insert(std::make_pair(type->first, sampler));
+	}
+
+	return pumaSampler;
+}
+
+/**
+*	@brief Tests a draw against the IPU constraints (chi-square test on person counts).
+*	The draw fits if the test passes or the maximum number of draws is reached; the
+*	fit is then recorded to the fit log.
+*	@param cons is IPU constraints
+*	@param count is counter of the draw
+*	@param num_draws is number of draws so far
+*	@param replicate is replicate id logged with the fit
+*	@return true if the draw fits
+*/
+bool Metro::checkFit(const Marginal *cons, const Counter *count, int num_draws, int replicate)
+{
+	int df = 0;
+	double p_val = getFitPValue(cons, count, df);
 	bool fit = false;
 
+	if(p_val > parameters->getAlpha())
+		fit = true;
+	else if(num_draws == parameters->getMaxDraws())
+		fit = true;
+
+	if(fit)
+		gofLog(p_val, df, num_draws, replicate, true);
+	
+	return fit;
+}
+
+/**
+*	@brief Chi-square test of drawn person counts against the IPU constraints
+*	@param cons is IPU constraints
+*	@param count is counter of the draw
+*	@param df receives number of tested categories
+*	@return p-value of the test
+*/
+double Metro::getFitPValue(const Marginal *cons, const Counter *count, int &df)
+{
+	std::vector<double> obsFreq, estFreq;
+
 	Pool temp_person_pool = *(parameters->getPersonPool());
 
 	int male_child_start = ACS::ChildAgeCat::_size()*ACS::Origin::_size();
@@ -289,7 +952,7 @@ bool Metro::checkFit(const Marginal *cons, const Counter *count, int num_draws)
 	std::cout << std::endl;
 	std::cout << "Starting chi-square test..." << std::endl;
 
-	int df = 0;
+	df = 0;
 	double sum_chi_sqr = 0;
 	int size = estFreq.size();
 	double diff = 0;
@@ -312,29 +975,84 @@ bool Metro::checkFit(const Marginal *cons, const Counter *count, int num_draws)
 	
 	//bool fit = (p_val < alpha) ? false : true;
 
-	if(p_val > parameters->getAlpha())
-		fit = true;
-	else if(num_draws == parameters->getMaxDraws())
-		fit = true;
+	return p_val;
+}
 
-	if(fit)
-		gofLog(p_val, df, num_draws);
-	
-	return fit;
+/**
+*	@brief Records fit of a draw. Records are kept until writeGofLog() so that
+*	the log is written in a deterministic order when MSAs, replicates or trials
+*	are drawn concurrently. Tagged draws are replicates when replicates are 
+*	generated ("--replicates"), model trials otherwise. Failed fits (of weighted
+*	records, which are not redrawn) are marked as failed.
+*/
+void Metro::gofLog(double pval, int df, int num_draws, int replicate, bool fit)
+{
+	std::ostringstream record;
+	record << geoID;
+	if(replicate != NO_REPLICATE)
+		record << ((parameters->getRunParam()->num_replicates > 1) ? ", replicate: " : ", trial: ") << replicate;
+
+	record << ", pvalue: " << pval << ", df: " << df << ", num_draws: " << num_draws;
+	if(!fit)
+		record << ", fit: failed";
+
+	//replicates and trials of an MSA are drawn concurrently
+	std::lock_guard<std::mutex> lock(*gofLock);
+	gofRecords.push_back(std::make_pair(replicate, record.str()));
 }
 
-void Metro::gofLog(double pval, int df, int num_draws)
+/**
+*	@brief Appends recorded fits (ordered by replicate id or trial) to the fit log
+*	(gofLog.txt, or the shard's own log in shard mode)
+*	@return void
+*/
+void Metro::writeGofLog()
 {
+	std::vector<std::pair<int, std::string>> records;
+	{
+		std::lock_guard<std::mutex> lock(*gofLock);
+		records.swap(gofRecords);
+	}
+
+	//MSAs share the log file
+	static std::mutex logMutex;
+	std::lock_guard<std::mutex> lock(logMutex);
+
 	std::ofstream logFile;
-	logFile.open("gofLog.txt", std::ios::app);
+	logFile.open(parameters->getGofLogFile(), std::ios::app);
 
 	if(!logFile.is_open())
 		exit(EXIT_SUCCESS);
 
-	logFile << geoID << ", pvalue: " << pval << ", df: " << df << ", num_draws: " << num_draws << std::endl;
+	std::stable_sort(records.begin(), records.end(), 
+		[](const std::pair<int, std::string> &a, const std::pair<int, std::string> &b){ return a.first < b.first; });
+
+	for(auto rec = records.begin(); rec != records.end(); ++rec)
+		logFile << rec->second << std::endl;
 
 	logFile.close();
+}
+
+//prints stage cache hits and misses of the MSA, if caching is enabled
+void Metro::printCacheReport() const
+{
+	if(stageCache != NULL)
+		std::cout << "Stage cache " << metroName << " (" << geoID << "): " << stageCache->getReport() << "\n" << std::endl;
+}
+
+/**
+*	@brief Releases IPU solution and PUMS records of the MSA once its population 
+*	is no longer drawn
+*	@return void
+*/
+void Metro::releaseIPU()
+{
+	if(ipuWrapper == NULL)
+		return;
 
+	delete ipuWrapper;
+	ipuWrapper = NULL;
+	ipuSolved = false;
 }
 
 //void Metro::normalDistCurve()
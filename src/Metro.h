@@ -7,6 +7,11 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
 #include <boost/range/algorithm.hpp>
 
 #include <boost/math/distributions/chi_squared.hpp>
@@ -19,6 +24,12 @@ class Parameters;
 class Counter;
 class IPUWrapper;
 class CardioModel;
+class Random;
+class StageCache;
+class StageHash;
+class CacheReader;
+
+#define NO_REPLICATE -1
 
 class Metro
 {
@@ -32,6 +43,9 @@ public:
 	typedef std::map<int,std::map<std::string, PairDD>> RiskFacMap;
 	typedef std::map<std::string, PairDD> PairMap;
 	typedef std::map<double, HouseholdPums> PUMSHouseholdsMap;
+	typedef std::map<double, double> WeightsMap;
+	typedef std::vector<PairDD> Sampler;
+	typedef std::map<std::string, Sampler> SamplerMap;
 	typedef std::multimap<int, County> CountyMap;
 	typedef std::vector<double> Marginal;
 	typedef std::vector<std::string> Pool;
@@ -54,18 +68,60 @@ public:
 
 	template <class T>
 	void createAgents(T *);
+	template <class T>
+	void createAgents(T *, Random &);
+	template <class T>
+	void createAgents(T *, Random &, int);
+	template <class T, class U>
+	void createAgents(T *, U *, Random &, int);
+
+	template <class Sink>
+	void generateAgents(Sink *);
+	template <class Sink>
+	void generateAgents(Sink *, Random &);
+
+	void generateReplicates(int);
+
+	void writeGofLog();
+
+	bool isIPUSolved() const;
+	void importPUMS();
+	void solveIPU();
+	void releaseIPU();
+	void printCacheReport() const;
 	
 protected:
+
+	void runIPU();
+
+	template <class Sink>
+	void generateAgents(Sink *, Random &, int);
 	
-	template <class T>
-	void drawHouseholds(IPUWrapper *, T *);
+	template <class Sink>
+	void drawHouseholds(IPUWrapper *, Sink *, Random &, int);
+
+	template <class Sink>
+	bool replayHouseholds(IPUWrapper *, Sink *, Random &, int, CacheReader &);
+
+	template <class Sink>
+	void writeWeightedRecords(IPUWrapper *, Sink *, int);
 
-	bool checkFit(const Marginal *, const Counter *, int);
-	void gofLog(double, int, int);
+	template <class Sink>
+	void streamHouseholds(IPUWrapper *, Sink *, Random &, int);
+
+	std::map<int, double> getPumaShares() const;
+	std::map<std::string, std::map<int, double>> getPumaTypeShares(const SamplerMap &, const PUMSHouseholdsMap *, const std::map<int, double> &) const;
+	SamplerMap getPumaSampler(const SamplerMap &, const PUMSHouseholdsMap *, int) const;
+
+	bool checkFit(const Marginal *, const Counter *, int, int);
+	double getFitPValue(const Marginal *, const Counter *, int &);
+	void gofLog(double, int, int, int, bool);
 	//void normalDistCurve();
 	
 	std::shared_ptr<Parameters> parameters;
 	IPUWrapper *ipuWrapper;
+	bool ipuSolved;
+	std::shared_ptr<StageCache> stageCache; //NULL: no caching
 	
 	std::string geoID;
 	std::string metroName;
@@ -73,6 +129,10 @@ protected:
 
 	CountyMap m_pumaCounty;
 	ACSEstimates m_metroACSEst;
+
+	//fit records of draws, written to gofLog.txt by writeGofLog(), guarded by gofLock
+	std::vector<std::pair<int, std::string>> gofRecords;
+	std::shared_ptr<std::mutex> gofLock;
 	
 };
 
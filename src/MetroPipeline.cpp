@@ -0,0 +1,122 @@
+#include "MetroPipeline.h"
+#include "Metro.h"
+
+#define IMPORT_STAGE 0
+#define IPU_STAGE 1
+#define DRAW_STAGE 2
+
+MetroPipeline::MetroPipeline(size_t d) : depth(d)
+{
+	const char *names[3] = {"import", "ipu", "draw"};
+	for(int i = 0; i < 3; ++i)
+	{
+		stats[i].name = names[i];
+		stats[i].num_items = 0;
+		stats[i].busy_ms = 0;
+		stats[i].starved_ms = 0;
+		stats[i].blocked_ms = 0;
+		stats[i].occupancy_sum = 0;
+	}
+}
+
+MetroPipeline::~MetroPipeline()
+{
+}
+
+/**
+*	@brief Runs MSAs through the pipeline in list order and returns when the last
+*	MSA has left the draw stage. A NULL entry marks the end of the stream.
+*	@param metros is list of MSAs
+*	@param drawStage draws population of an MSA and runs the model on it
+*	@return void
+*/
+void MetroPipeline::run(const std::vector<Metro*> &metros, const Stage &drawStage)
+{
+	BoundedQueue<Metro*> imported(depth), solved(depth);
+
+	std::thread importer([&]()
+	{
+		for(auto metro = metros.begin(); metro != metros.end(); ++metro)
+		{
+			TimePoint start = std::chrono::steady_clock::now();
+			(*metro)->importPUMS();
+			stats[IMPORT_STAGE].busy_ms += ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+			stats[IMPORT_STAGE].num_items++;
+
+			push(imported, *metro, stats[IMPORT_STAGE]);
+		}
+		push(imported, NULL, stats[IMPORT_STAGE]);
+	});
+
+	std::thread solver([&]()
+	{
+		Metro *metro;
+		while((metro = pop(imported, stats[IPU_STAGE])) != NULL)
+		{
+			TimePoint start = std::chrono::steady_clock::now();
+			metro->solveIPU();
+			stats[IPU_STAGE].busy_ms += ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+			stats[IPU_STAGE].num_items++;
+
+			push(solved, metro, stats[IPU_STAGE]);
+		}
+		push(solved, NULL, stats[IPU_STAGE]);
+	});
+
+	Metro *metro;
+	while((metro = pop(solved, stats[DRAW_STAGE])) != NULL)
+	{
+		TimePoint start = std::chrono::steady_clock::now();
+		drawStage(metro);
+		stats[DRAW_STAGE].busy_ms += ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+		stats[DRAW_STAGE].num_items++;
+	}
+
+	importer.join();
+	solver.join();
+}
+
+/**
+*	@brief Prints per-stage occupancy: time working, waiting for input (starved),
+*	blocked by a full output queue (back-pressure) and mean input queue length
+*	@return void
+*/
+void MetroPipeline::printStats() const
+{
+	std::cout << "Pipeline stages (queue depth " << depth << "):" << std::endl;
+	std::cout << "stage, items, busy(s), starved(s), blocked(s), busy(%), mean input queue" << std::endl;
+
+	for(int i = 0; i < 3; ++i)
+	{
+		const StageStats *st = &stats[i];
+		double total = st->busy_ms+st->starved_ms+st->blocked_ms;
+		double busy_pct = (total > 0) ? 100*st->busy_ms/total : 0;
+		double mean_queue = (i > 0 && st->num_items > 0) ? (double)st->occupancy_sum/st->num_items : 0;
+
+		std::cout << std::setprecision(4) << st->name << ", " << st->num_items << ", " << st->busy_ms/1000 << ", "
+			<< st->starved_ms/1000 << ", " << st->blocked_ms/1000 << ", " << busy_pct << ", " << mean_queue << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+void MetroPipeline::push(BoundedQueue<Metro*> &queue, Metro *metro, StageStats &st)
+{
+	TimePoint start = std::chrono::steady_clock::now();
+	while(!queue.tryPush(metro))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	st.blocked_ms += ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+}
+
+Metro * MetroPipeline::pop(BoundedQueue<Metro*> &queue, StageStats &st)
+{
+	TimePoint start = std::chrono::steady_clock::now();
+	st.occupancy_sum += queue.size();
+
+	Metro *metro;
+	while(!queue.tryPop(metro))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	st.starved_ms += ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+	return metro;
+}
@@ -0,0 +1,106 @@
+#ifndef __MetroPipeline_h__
+#define __MetroPipeline_h__
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include "ElapsedTime.h"
+
+class Metro;
+
+/**
+*	@brief Bounded single-producer/single-consumer queue on a ring buffer. Push and
+*	pop are lock-free; a full queue rejects pushes, which is the back-pressure
+*	between pipeline stages.
+*/
+template <class T>
+class BoundedQueue
+{
+public:
+	BoundedQueue(size_t capacity) : buffer(capacity+1), head(0), tail(0)
+	{
+	}
+
+	bool tryPush(const T &item)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t next = (t+1) % buffer.size();
+		if(next == head.load(std::memory_order_acquire))
+			return false;
+
+		buffer[t] = item;
+		tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(T &item)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if(h == tail.load(std::memory_order_acquire))
+			return false;
+
+		item = buffer[h];
+		head.store((h+1) % buffer.size(), std::memory_order_release);
+		return true;
+	}
+
+	size_t size() const
+	{
+		size_t h = head.load(std::memory_order_acquire);
+		size_t t = tail.load(std::memory_order_acquire);
+		return (t+buffer.size()-h) % buffer.size();
+	}
+
+	size_t capacity() const
+	{
+		return buffer.size()-1;
+	}
+
+private:
+	std::vector<T> buffer;
+	std::atomic<size_t> head; //next slot to pop (consumer)
+	std::atomic<size_t> tail; //next slot to push (producer)
+};
+
+//time a pipeline stage spent working, waiting for input and blocked on output
+struct StageStats
+{
+	std::string name;
+	size_t num_items;
+	double busy_ms;
+	double starved_ms;
+	double blocked_ms;
+	size_t occupancy_sum; //queue length seen by the stage at each pop
+};
+
+/**
+*	@brief Runs MSAs through three stages on their own threads: PUMS import, IPU
+*	and drawing/model. Stages are connected by bounded queues of depth D, so the
+*	import stage prefetches MSA k+1 while MSA k is in IPU and MSA k-1 is drawn, and
+*	at most 2D+3 MSAs hold PUMS records at any time.
+*/
+class MetroPipeline
+{
+public:
+	typedef std::function<void(Metro *)> Stage;
+
+	MetroPipeline(size_t);
+	virtual ~MetroPipeline();
+
+	void run(const std::vector<Metro*> &, const Stage &);
+	void printStats() const;
+
+private:
+	void push(BoundedQueue<Metro*> &, Metro *, StageStats &);
+	Metro *pop(BoundedQueue<Metro*> &, StageStats &);
+
+	size_t depth;
+	StageStats stats[3];
+};
+
+#endif __MetroPipeline_h__
@@ -0,0 +1,82 @@
+#include "MultiModel.h"
+#include "Metro.h"
+#include "Random.h"
+#include "Parameters.h"
+#include "CardioModel.h"
+#include "ViolenceModel.h"
+
+MultiModel::MultiModel()
+{
+}
+
+MultiModel::~MultiModel()
+{
+}
+
+/**
+*	@brief Runs both models on the MSA selected with "--msa" (DEFAULT_MSA unless
+*	selected)
+*	@return void
+*/
+void MultiModel::start()
+{
+	if(parameters == NULL)
+	{
+		std::cout << "Error: Parameters are not initialized!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	const RunParams *runParam = parameters->getRunParam();
+	if(runParam->num_replicates > 1)
+	{
+		std::cout << "Error: Replicates are not supported when running both models!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	std::vector<Metro*> metros = getSelectedMetros(DEFAULT_MSA);
+	if(metros.size() != 1)
+	{
+		std::cout << "Error: Both models run on a single MSA!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	run(metros.front());
+}
+
+/**
+*	@brief Draws the population of an MSA once for both models, then completes 
+*	the CVD model and the Mass Violence trials
+*	@param metro is MSA
+*	@return void
+*/
+void MultiModel::run(Metro *metro)
+{
+	//each model reads its own inputs through parameters of its own type
+	std::shared_ptr<Parameters> cardioParam = std::make_shared<Parameters>(*parameters);
+	cardioParam->setSimType(EQUITY_EFFICIENCY);
+
+	std::shared_ptr<Parameters> violenceParam = std::make_shared<Parameters>(*parameters);
+	violenceParam->setSimType(MASS_VIOLENCE);
+
+	CardioModel cardio(cardioParam);
+	ViolenceModel violence(violenceParam);
+
+	violence.initialize(metro);
+
+	Random random(parameters->getRunParam()->seed, metro->getGeoID(), 0, RNG_PHASE_DRAW);
+	cardio.prepareMetro(metro, random);
+	violence.startTrial(metro, 0);
+
+	metro->createAgents(&cardio, &violence, random, 0);
+
+	cardio.finishMetro(metro);
+	violence.finishTrial(metro);
+
+	int num_trials = violenceParam->getViolenceParam()->num_trials;
+	for(int i = 1; i < num_trials; ++i)
+		violence.runTrial(metro, i);
+
+	metro->writeGofLog();
+	violence.output();
+	metro->releaseIPU();
+}
@@ -0,0 +1,33 @@
+#ifndef __MultiModel_h__
+#define __MultiModel_h__
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "PopBrewer.h"
+
+class Metro;
+
+/**
+*	@brief Runs the CVD and Mass Violence models on one synthesized population.
+*	PUMS import, IPF, IPU and the household draw of the MSA are done once; every
+*	drawn household and person is handed to both models in the same pass (see 
+*	FanOutSink). Each model has its own parameters, counter and outputs. The 
+*	shared draw uses the stream both models would use on their own, so their 
+*	outputs match those of separate runs. The first Mass Violence trial runs on
+*	the shared population; later trials draw their own population as usual.
+*/
+class MultiModel : public PopBrewer
+{
+public:
+	MultiModel();
+	virtual ~MultiModel();
+
+	void start();
+
+private:
+	void run(Metro *);
+};
+
+#endif __MultiModel_h__
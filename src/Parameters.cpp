@@ -20,10 +20,32 @@
 #include "Parameters.h"
 #include "csv.h"
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 
 Parameters::Parameters(const char *inDir, const char *outDir, const int simModel) : 
-	inputDir(inDir), outputDir(outDir), alpha(0.05), minSampleSize(1000.0), max_draws(200), simType(simModel), output(true)
+	inputDir(inDir), outputDir(outDir), alpha(0.05), minSampleSize(1000.0), max_draws(200), simType(simModel), output(true), 
+	cardioInputs(false), violenceInputs(false), inputs(std::make_shared<Inputs>())
 {
+	runParams.pop_mode = POP_EXPANDED;
+	runParams.stream_sink = STREAM_TO_MODEL;
+	runParams.num_replicates = 1;
+	runParams.num_threads = 0;
+	runParams.seed = DEFAULT_SEED;
+	runParams.mem_budget = 0;
+	runParams.shard_id = 0;
+	runParams.num_shards = 1;
+	runParams.merge_shards = 0;
+	runParams.pipeline_depth = 0;
+	runParams.cache_dir = "";
+	runParams.max_trials = 0;
+	runParams.redraw_trials = 1;
+	runParams.tick_order = TICK_MAJOR;
+
 	readACSCodeBookFile();
 	readAgeGenderMappingFile();
 	readHHIncomeMappingFile();
@@ -33,18 +55,7 @@ Parameters::Parameters(const char *inDir, const char *outDir, const int simModel
 	createPersonPool();
 	createNhanesPool();
 
-	if(simType == EQUITY_EFFICIENCY)
-	{
-		readNHANESRiskFactors();
-		readFraminghamCoefficients();
-	}
-	else if(simType == MASS_VIOLENCE)
-	{
-		readSchoolDemograhics();
-		readMassViolenceInputs();
-		readPtsdSymptoms();
-	}
-		
+	readModelInputs();
 }
 
 Parameters::~Parameters()
@@ -62,6 +73,20 @@ std::string Parameters::getOutputDir() const
 	return outputDir;
 }
 
+/**
+*	@brief Creates a directory (one level) if it does not exist
+*	@param dir is path of the directory
+*	@return void
+*/
+void Parameters::createDirectory(const std::string &dir)
+{
+#ifdef _WIN32
+	_mkdir(dir.c_str());
+#else
+	mkdir(dir.c_str(), 0755);
+#endif
+}
+
 const char* Parameters::getMSAListFile() 
 {
 	return getFilePath("ACS_15_METRO_LIST_fullList.csv");
@@ -139,24 +164,254 @@ short int Parameters::getSimType() const
 	return simType;
 }
 
+/**
+*	@brief Switches simulation model, reading its inputs unless already read
+*	@param simModel is simulation model (EET=1, MVS=2 or both=3)
+*	@return void
+*/
+void Parameters::setSimType(int simModel)
+{
+	simType = simModel;
+	readModelInputs();
+}
+
+/**
+*	@brief Reads inputs of the models of the simulation type that are not read yet.
+*	Input tables shared with copies of these parameters are copied before they are
+*	extended, so that the copies are not changed.
+*	@return void
+*/
+void Parameters::readModelInputs()
+{
+	bool readCardio = (simType == EQUITY_EFFICIENCY || simType == MULTI_MODEL) && !cardioInputs;
+	bool readViolence = (simType == MASS_VIOLENCE || simType == MULTI_MODEL) && !violenceInputs;
+	if((readCardio || readViolence) && inputs.use_count() > 1)
+		inputs = std::make_shared<Inputs>(*inputs);
+
+	if((simType == EQUITY_EFFICIENCY || simType == MULTI_MODEL) && !cardioInputs)
+	{
+		readNHANESRiskFactors();
+		readFraminghamCoefficients();
+		cardioInputs = true;
+	}
+
+	if((simType == MASS_VIOLENCE || simType == MULTI_MODEL) && !violenceInputs)
+	{
+		readSchoolDemograhics();
+		readMassViolenceInputs();
+		readPtsdSymptoms();
+		readTreatmentUptake();
+		violenceInputs = true;
+	}
+}
+
 bool Parameters::writeToFile() const
 {
 	return output;
 }
 
+/**
+*	@brief Sets run options passed on the command line as --option=value
+*	@param m_options is a map of option names and their values
+*	@return void
+*/
+void Parameters::setRunParams(const MapStr *m_options)
+{
+	for(auto opt = m_options->begin(); opt != m_options->end(); ++opt)
+	{
+		if(opt->first == "population")
+		{
+			if(opt->second == "expanded")
+				runParams.pop_mode = POP_EXPANDED;
+			else if(opt->second == "weighted")
+				runParams.pop_mode = POP_WEIGHTED;
+			else if(opt->second == "streaming")
+				runParams.pop_mode = POP_STREAMING;
+			else
+			{
+				std::cout << "Error: Invalid population mode: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "stream-sink")
+		{
+			if(opt->second == "model")
+				runParams.stream_sink = STREAM_TO_MODEL;
+			else if(opt->second == "file")
+				runParams.stream_sink = STREAM_TO_FILE;
+			else
+			{
+				std::cout << "Error: Invalid stream sink: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "tick-order")
+		{
+			if(opt->second == "tick")
+				runParams.tick_order = TICK_MAJOR;
+			else if(opt->second == "agent")
+				runParams.tick_order = AGENT_MAJOR;
+			else
+			{
+				std::cout << "Error: Invalid tick order: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "pipeline")
+		{
+			runParams.pipeline_depth = std::atoi(opt->second.c_str());
+			if(runParams.pipeline_depth < 1)
+			{
+				std::cout << "Error: Invalid pipeline depth: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "replicates" || opt->first == "threads" || opt->first == "concurrent-trials")
+		{
+			int val = std::atoi(opt->second.c_str());
+			if(val < 1)
+			{
+				std::cout << "Error: Invalid value of --" << opt->first << ": " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+
+			if(opt->first == "replicates")
+				runParams.num_replicates = val;
+			else if(opt->first == "threads")
+				runParams.num_threads = val;
+			else
+				runParams.max_trials = val;
+		}
+		else if(opt->first == "redraw-every")
+		{
+			if(opt->second.empty() || opt->second.find_first_not_of("0123456789") != std::string::npos)
+			{
+				std::cout << "Error: Invalid value of --redraw-every: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+
+			runParams.redraw_trials = std::atoi(opt->second.c_str());
+		}
+		else if(opt->first == "seed")
+		{
+			runParams.seed = (unsigned int)std::strtoul(opt->second.c_str(), NULL, 10);
+		}
+		else if(opt->first == "msa")
+		{
+			runParams.msa_list.clear();
+			if(opt->second != "all")
+			{
+				boost::char_separator<char> sep(",");
+				boost::tokenizer<boost::char_separator<char>> tokens(opt->second, sep);
+				for(auto tok = tokens.begin(); tok != tokens.end(); ++tok)
+					runParams.msa_list.push_back(*tok);
+			}
+		}
+		else if(opt->first == "shard")
+		{
+			size_t sep = opt->second.find('/');
+			if(sep != std::string::npos)
+			{
+				runParams.shard_id = std::atoi(opt->second.substr(0, sep).c_str());
+				runParams.num_shards = std::atoi(opt->second.substr(sep+1).c_str());
+			}
+
+			if(sep == std::string::npos || runParams.num_shards < 1 || runParams.shard_id < 0 || runParams.shard_id >= runParams.num_shards)
+			{
+				std::cout << "Error: Invalid shard: " << opt->second << "! Expected i/N with 0 <= i < N." << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "merge-shards")
+		{
+			runParams.merge_shards = std::atoi(opt->second.c_str());
+			if(runParams.merge_shards < 1)
+			{
+				std::cout << "Error: Invalid number of shards: " << opt->second << "!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+		}
+		else if(opt->first == "memory-budget")
+		{
+			//given in megabytes
+			runParams.mem_budget = (size_t)std::strtoul(opt->second.c_str(), NULL, 10)*1024*1024;
+		}
+		else if(opt->first == "cache")
+		{
+			//"--cache" alone caches in <output>/cache/
+			runParams.cache_dir = (opt->second == "1") ? outputDir+"cache/" : opt->second;
+			if(!runParams.cache_dir.empty() && runParams.cache_dir.back() != '/')
+				runParams.cache_dir += "/";
+		}
+		else if(opt->first == "daemon" || opt->first == "manifest" || opt->first == "journal" || opt->first == "benchmark-rng")
+		{
+			//run modes handled by main
+		}
+		else
+		{
+			std::cout << "Error: Unknown option --" << opt->first << "!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+	}
+}
+
+/**
+*	@brief Returns name of the goodness-of-fit log of this process
+*	@return "gofLog.txt", or "gofLog_<i>of<N>.txt" when run as shard i of N
+*/
+std::string Parameters::getGofLogFile() const
+{
+	if(runParams.num_shards > 1)
+		return getGofLogFile(runParams.shard_id, runParams.num_shards);
+
+	return "gofLog.txt";
+}
+
+std::string Parameters::getGofLogFile(int shard, int num_shards) const
+{
+	return "gofLog_" + std::to_string(shard) + "of" + std::to_string(num_shards) + ".txt";
+}
+
+void Parameters::setOutputDir(const std::string &dir)
+{
+	outputDir = dir;
+}
+
+void Parameters::setSeed(unsigned int seed)
+{
+	runParams.seed = seed;
+}
+
+const RunParams * Parameters::getRunParam() const
+{
+	return &runParams;
+}
+
 const Parameters::Pool * Parameters::getHouseholdPool() const
 {
-	return &hhPool;
+	return &inputs->hhPool;
 }
 
 const Parameters::Pool * Parameters::getPersonPool() const
 {
-	return &personPool;
+	return &inputs->personPool;
+}
+
+/**
+*	@brief Returns position of a person type in the person pool, which is also its
+*	index in person counts (see Counter::initPersonCounter())
+*	@param personType is person type
+*	@return position in person pool, -1 if type is not in the pool
+*/
+int Parameters::getPersonPoolIndex(const std::string &personType) const
+{
+	auto it = inputs->personPoolIndex.find(personType);
+	return (it != inputs->personPoolIndex.end()) ? it->second : -1;
 }
 
 const Parameters::Pool * Parameters::getNhanesPool() const
 {
-	return &nhanesPool;
+	return &inputs->nhanesPool;
 }
 
 //std::unordered_multimap<int, int> Parameters::getVariableMap(int type) const
@@ -167,10 +422,10 @@ std::multimap<int, int> Parameters::getVariableMap(int type) const
 	switch(type)
 	{
 	case ACS::Estimates::estEducation:
-		return m_eduAgeGender;
+		return inputs->m_eduAgeGender;
 		break;
 	case ACS::Estimates::estHHIncome:
-		return m_hhIncome;
+		return inputs->m_hhIncome;
 		break;
 	default:
 		return temp;
@@ -181,13 +436,13 @@ std::multimap<int, int> Parameters::getVariableMap(int type) const
 //std::unordered_map<std::string, int> Parameters::getOriginMapping() const
 Parameters::MapInt Parameters::getOriginMapping() const
 {
-	return m_originByRace;
+	return inputs->m_originByRace;
 }
 
 Parameters::MapInt Parameters::getSchoolDemographics() 
 {
 	if(simType == MASS_VIOLENCE)
-		return m_schoolDemo;
+		return inputs->m_schoolDemo;
 	else{
 		std::cout << "Error: Wrong simulation model selected!" << std::endl;
 		exit(EXIT_SUCCESS);
@@ -197,7 +452,7 @@ Parameters::MapInt Parameters::getSchoolDemographics()
 Parameters::PairMap * Parameters::getPtsdSymptoms() 
 {
 	if(simType == MASS_VIOLENCE)
-		return &m_ptsdx;
+		return &inputs->m_ptsdx;
 	else{
 		std::cout << "Error: Wrong simulation model selected!" << std::endl;
 		exit(EXIT_SUCCESS);
@@ -251,18 +506,18 @@ const EET::CardioParams* Parameters::getCardioParam()
 
 Parameters::MultiMapCB Parameters::getACSCodeBook() const
 {
-	return m_acsCodes;
+	return inputs->m_acsCodes;
 }
 
 Parameters::ProbMap Parameters::getRiskStrataProbability() const
 {
-	return m_riskStrataProb;
+	return inputs->m_riskStrataProb;
 }
 
 const Parameters::PairMap * Parameters::getRiskFactorMap(int type)
 {
-	if(m_risks.count(type) > 0)
-		return &m_risks[type];
+	if(inputs->m_risks.count(type) > 0)
+		return &inputs->m_risks[type];
 	else{
 		std::cout << "Error: Risk factor type = " << type << " doesn't exist!" << std::endl;
 		exit(EXIT_SUCCESS);
@@ -318,19 +573,19 @@ void Parameters::readACSCodeBookFile()
 			for(auto it = row.begin()+1; it != row.end(); ++it)
 			{
 				if(!it->empty())
-					m_codeBook.insert(std::make_pair(codeACS, *it));
+					inputs->m_codeBook.insert(std::make_pair(codeACS, *it));
 			}
 			col.clear();
 			row.clear();
 		}
 	}
 
-	m_acsCodes.insert(make_pair(ACS::PumsVar::RAC1P, createCodeBookMap(ACS::PumsVar::RAC1P)));
-	m_acsCodes.insert(make_pair(ACS::PumsVar::SCHL, createCodeBookMap(ACS::PumsVar::SCHL)));
-	m_acsCodes.insert(make_pair(ACS::PumsVar::AGEP, createCodeBookMap(ACS::PumsVar::AGEP)));
+	inputs->m_acsCodes.insert(make_pair(ACS::PumsVar::RAC1P, createCodeBookMap(ACS::PumsVar::RAC1P)));
+	inputs->m_acsCodes.insert(make_pair(ACS::PumsVar::SCHL, createCodeBookMap(ACS::PumsVar::SCHL)));
+	inputs->m_acsCodes.insert(make_pair(ACS::PumsVar::AGEP, createCodeBookMap(ACS::PumsVar::AGEP)));
 
-	m_acsCodes.insert(make_pair(ACS::PumsVar::HHT, createCodeBookMap(ACS::PumsVar::HHT)));
-	m_acsCodes.insert(make_pair(ACS::PumsVar::HINCP, createCodeBookMap(ACS::PumsVar::HINCP)));
+	inputs->m_acsCodes.insert(make_pair(ACS::PumsVar::HHT, createCodeBookMap(ACS::PumsVar::HHT)));
+	inputs->m_acsCodes.insert(make_pair(ACS::PumsVar::HINCP, createCodeBookMap(ACS::PumsVar::HINCP)));
 
 }
 
@@ -361,7 +616,7 @@ void Parameters::readAgeGenderMappingFile()
 		if(r_eduAge != "NULL")
 		{
 			int eduAge = ACS::EduAgeCat::_from_string(edu_age_range);
-			m_eduAgeGender.insert(std::make_pair(10*sex+eduAge, raceVarIdx-1));
+			inputs->m_eduAgeGender.insert(std::make_pair(10*sex+eduAge, raceVarIdx-1));
 		}
 
 	}
@@ -386,7 +641,7 @@ void Parameters::readHHIncomeMappingFile()
 		int hhIncCat = ACS::HHIncome::_from_string(hhIncStr);
 		int hhIncIdx = ACS::HHIncMarginalVar::_from_string(var_name);
 
-		m_hhIncome.insert(std::make_pair(hhIncCat, hhIncIdx));
+		inputs->m_hhIncome.insert(std::make_pair(hhIncCat, hhIncIdx));
 	}
 
 }
@@ -403,7 +658,7 @@ void Parameters::readOriginListFile()
 	originList.erase(originList.begin());
 
 	for(auto row = originList.begin(); row != originList.end(); ++row)
-		m_originByRace.insert(std::make_pair(row->front(), std::stoi(row->back())));
+		inputs->m_originByRace.insert(std::make_pair(row->front(), std::stoi(row->back())));
 }
 
 
@@ -435,7 +690,7 @@ void Parameters::readNHANESRiskFactors()
 		std::string key_person_type = getNHANESpersonType(race, sex, age_cat, edu_cat);;
 		std::string key_risk = std::to_string(risk_strata)+key_person_type;
 
-		if(m_riskStrataProb.count(key_person_type) == 0)
+		if(inputs->m_riskStrataProb.count(key_person_type) == 0)
 		{
 			std::vector<PairDD> temp_pair;
 			std::vector<double> temp_prob;
@@ -443,12 +698,12 @@ void Parameters::readNHANESRiskFactors()
 			temp_pair.push_back(PairDD(freq_, risk_strata));
 			temp_prob.push_back(freq_);
 
-			m_riskStrataProb.insert(std::make_pair(key_person_type, temp_pair));
+			inputs->m_riskStrataProb.insert(std::make_pair(key_person_type, temp_pair));
 			m_tempFreq.insert(std::make_pair(key_person_type, temp_prob));
 		}
 		else
 		{
-			m_riskStrataProb[key_person_type].push_back(PairDD(freq_, risk_strata));
+			inputs->m_riskStrataProb[key_person_type].push_back(PairDD(freq_, risk_strata));
 			m_tempFreq[key_person_type].push_back(freq_);
 		}
 
@@ -465,18 +720,18 @@ void Parameters::readNHANESRiskFactors()
 	{
 		double sum_pop = std::accumulate(itr->second.begin(), itr->second.end(), 0.0);
 		
-		vec_pairs = m_riskStrataProb[itr->first];
+		vec_pairs = inputs->m_riskStrataProb[itr->first];
 		for(size_t i = 0; i < vec_pairs.size(); ++i)
 			vec_pairs[i].first = vec_pairs[i].first/sum_pop;
 
-		m_riskStrataProb[itr->first] = vec_pairs;
+		inputs->m_riskStrataProb[itr->first] = vec_pairs;
 
 	}
 
-	m_risks.insert(std::make_pair(NHANES::RiskFac::totalChols, m_tchols));
-	m_risks.insert(std::make_pair(NHANES::RiskFac::HdlChols, m_hdlChols));
-	m_risks.insert(std::make_pair(NHANES::RiskFac::SystolicBp, m_sysBp));
-	m_risks.insert(std::make_pair(NHANES::RiskFac::SmokingStat, m_smoking));
+	inputs->m_risks.insert(std::make_pair(NHANES::RiskFac::totalChols, m_tchols));
+	inputs->m_risks.insert(std::make_pair(NHANES::RiskFac::HdlChols, m_hdlChols));
+	inputs->m_risks.insert(std::make_pair(NHANES::RiskFac::SystolicBp, m_sysBp));
+	inputs->m_risks.insert(std::make_pair(NHANES::RiskFac::SmokingStat, m_smoking));
 
 	//readNHANESRiskFactorsCI();
 }
@@ -624,7 +879,7 @@ void Parameters::readSchoolDemograhics()
 		int i_origin = ACS::Origin::_from_string(origin);
 		
 		std::string key_school_demo = std::to_string(i_gender)+std::to_string(i_origin);
-		m_schoolDemo.insert(std::make_pair(key_school_demo, std::stoi(count)));
+		inputs->m_schoolDemo.insert(std::make_pair(key_school_demo, std::stoi(count)));
 	}
 }
 
@@ -636,11 +891,26 @@ void Parameters::readMassViolenceInputs()
 	const char* var = NULL;
 	const char* val = NULL;
 
-	MapDbl m_massViolenceParams;
 	while(social_network_params.read_row(var, val))
-		m_massViolenceParams.insert(std::make_pair(var, std::stod(val)));
+		m_violenceInputs.insert(std::make_pair(var, std::stod(val)));
+
+	setViolenceParams(&m_violenceInputs);
+}
+
+/**
+*	@brief Overrides a Mass Violence model input of mass_violence_input.csv
+*	@param var is name of the input variable
+*	@param val is new value
+*	@return false if the variable doesn't exist
+*/
+bool Parameters::setViolenceParam(const std::string &var, double val)
+{
+	if(m_violenceInputs.count(var) == 0)
+		return false;
 
-	setViolenceParams(&m_massViolenceParams);
+	m_violenceInputs[var] = val;
+	setViolenceParams(&m_violenceInputs);
+	return true;
 }
 
 void Parameters::readPtsdSymptoms()
@@ -665,8 +935,62 @@ void Parameters::readPtsdSymptoms()
 		ptsdx.second = std::stod(std_err);
 
 		key = std::to_string(i_gender)+std::to_string(i_age)+s_ptsd;
-		m_ptsdx.insert(std::make_pair(key, ptsdx));
+		inputs->m_ptsdx.insert(std::make_pair(key, ptsdx));
+	}
+}
+
+/**
+*	@brief Reads coefficients of the logistic models of treatment uptake, one row
+*	per model: uptake (prior or referred), PTSD case status (0 or 1) and treatment
+*	(CBT or SPR)
+*	@return void
+*/
+void Parameters::readTreatmentUptake()
+{
+	io::CSVReader<11>uptake_file(getFilePath("mass_violence/treatment_uptake.csv"));
+	uptake_file.read_header(io::ignore_extra_column, "Uptake", "Case", "Treatment", "Intercept", "Male", "Black", "Hispanic", 
+		"Other", "Age_35_64", "Age_65_", "Prior");
+
+	const char *uptake = NULL; const char *s_case = NULL; const char *treatment = NULL;
+	const char *intercept = NULL; const char *male = NULL;
+	const char *black = NULL; const char *hispanic = NULL; const char *other = NULL;
+	const char *age_35_64 = NULL; const char *age_65_ = NULL; const char *prior = NULL;
+
+	bool found[2][2][2] = {};
+	while(uptake_file.read_row(uptake, s_case, treatment, intercept, male, black, hispanic, other, age_35_64, age_65_, prior))
+	{
+		int i = (strcmp(uptake, "prior") == 0) ? UPTAKE_PRIOR : ((strcmp(uptake, "referred") == 0) ? UPTAKE_REFERRED : -1);
+		int ptsd_case = std::atoi(s_case);
+		int k = (strcmp(treatment, "CBT") == 0) ? 0 : ((strcmp(treatment, "SPR") == 0) ? 1 : -1);
+
+		if(i < 0 || k < 0 || ptsd_case < 0 || ptsd_case > 1)
+		{
+			std::cout << "Error: Invalid treatment uptake model: " << uptake << "," << s_case << "," << treatment << "!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		MVS::UptakeModel model;
+		model.intercept = std::stod(intercept);
+		model.male = std::stod(male);
+		model.black = std::stod(black);
+		model.hispanic = std::stod(hispanic);
+		model.other = std::stod(other);
+		model.age_35_64 = std::stod(age_35_64);
+		model.age_65_ = std::stod(age_65_);
+		model.prior = std::stod(prior);
+
+		vParams.uptake[i][ptsd_case][k] = model;
+		found[i][ptsd_case][k] = true;
 	}
+
+	for(int i = 0; i < 2; ++i)
+		for(int j = 0; j < 2; ++j)
+			for(int k = 0; k < 2; ++k)
+				if(!found[i][j][k])
+				{
+					std::cout << "Error: Treatment uptake model " << i << "," << j << "," << k << " is missing!" << std::endl;
+					exit(EXIT_SUCCESS);
+				}
 }
 
 void Parameters::setViolenceParams(MapDbl *m_param)
@@ -732,12 +1056,12 @@ void Parameters::createHouseholdPool()
 	std::string gqSize = "1";
 	std::string gqInc = "-1";
 
-	hhPool.push_back(gqType+gqSize+gqInc);
+	inputs->hhPool.push_back(gqType+gqSize+gqInc);
 
 	for(auto hhType : ACS::HHType::_values())
 		for(auto hhSize : ACS::HHSize::_values())
 			for(auto hhInc : ACS::HHIncome::_values())
-				hhPool.push_back(std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc));
+				inputs->hhPool.push_back(std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc));
 
 }
 
@@ -753,14 +1077,17 @@ void Parameters::createPersonPool()
 	for(auto sex : ACS::Sex::_values())
 		for(auto ageCat : ACS::AgeCat::_values())
 			for(auto org : ACS::Origin::_values())
-				personPool.push_back(dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org));
+				inputs->personPool.push_back(dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org));
 
 	//pool of person by sex, education age cat, origin and education attainment
 	for(auto sex : ACS::Sex::_values())
 		for(auto eduAge : ACS::EduAgeCat::_values())
 			for(auto org : ACS::Origin::_values())
 				for(auto edu : ACS::Education::_values())
-					personPool.push_back(std::to_string(sex)+std::to_string(eduAge)+std::to_string(org)+std::to_string(edu));
+					inputs->personPool.push_back(std::to_string(sex)+std::to_string(eduAge)+std::to_string(org)+std::to_string(edu));
+
+	for(size_t pp = 0; pp < inputs->personPool.size(); ++pp)
+		inputs->personPoolIndex.insert(std::make_pair(inputs->personPool[pp], (int)pp));
 }
 
 void Parameters::createNhanesPool()
@@ -769,7 +1096,7 @@ void Parameters::createNhanesPool()
 		for(auto sex : NHANES::Sex::_values())
 			for(auto age : NHANES::AgeCat::_values())
 				for(auto edu : NHANES::Edu::_values())
-					nhanesPool.push_back(std::to_string(org)+std::to_string(sex)+std::to_string(age)+std::to_string(edu));
+					inputs->nhanesPool.push_back(std::to_string(org)+std::to_string(sex)+std::to_string(age)+std::to_string(edu));
 }
 
 std::string Parameters::getNHANESpersonType(const char *race, const char *sex, const char *age, const char *edu)
@@ -792,7 +1119,7 @@ Parameters::MapInt Parameters::createCodeBookMap(ACS::PumsVar var)
 	MapInt map;
 	std::string str = var._to_string();
 
-	auto its = m_codeBook.equal_range(str);
+	auto its = inputs->m_codeBook.equal_range(str);
 
 	for(auto it = its.first; it != its.second; ++it)
 	{
@@ -801,7 +1128,7 @@ Parameters::MapInt Parameters::createCodeBookMap(ACS::PumsVar var)
 		map.insert(std::make_pair(key, val));
 	}
 
-	m_codeBook.erase(str);
+	inputs->m_codeBook.erase(str);
 
 	return map;
 }
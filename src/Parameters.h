@@ -7,7 +7,10 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <memory>
 #include <numeric>
+#include <cstdlib>
+#include <ctime>
 //#include <unordered_map>
 #include <boost/tokenizer.hpp>
 #include "ACS.h"
@@ -15,10 +18,59 @@
 
 #define EQUITY_EFFICIENCY 1
 #define MASS_VIOLENCE 2
+#define MULTI_MODEL 3 //both models on one drawn population
+
+//Population output modes
+#define POP_EXPANDED 0
+#define POP_WEIGHTED 1
+#define POP_STREAMING 2
+
+//Sinks of PUMA-by-PUMA streaming mode
+#define STREAM_TO_MODEL 0
+#define STREAM_TO_FILE 1
+
+//Orders of MV model tick execution
+#define TICK_MAJOR 0 //all agents through a tick, tick by tick
+#define AGENT_MAJOR 1 //a block of agents through all ticks, block by block
+
+//Base seed of random number streams when --seed is not given, so runs replay by default
+#define DEFAULT_SEED 20170101
+
+//Run options set from the command line as --option=value
+struct RunParams
+{
+	int pop_mode;
+	int stream_sink;
+	int num_replicates;
+	int num_threads; //0: number of hardware threads
+	unsigned int seed;
+	std::vector<std::string> msa_list; //empty: model default (all MSAs for CVD model)
+	size_t mem_budget; //bytes, 0: unlimited
+	int shard_id, num_shards; //shard i of N (0 <= i < N)
+	int merge_shards; //>0: merge outputs of this many shards and exit
+	int pipeline_depth; //>0: run MSAs through import/IPU/draw pipeline with queues of this depth
+	std::string cache_dir; //directory of stage cache, empty: no caching
+	int max_trials; //MV model: trials run concurrently, 0: one per thread
+	int redraw_trials; //MV model: population, school and network drawn every K trials and restored in between, 0: drawn once
+	int tick_order; //MV model: TICK_MAJOR or AGENT_MAJOR
+};
+
+//treatment uptake models of the Violence Model
+#define UPTAKE_PRIOR 0 //prior treatment, at the start of the run
+#define UPTAKE_REFERRED 1 //treatment after screening
 
 //Violence Model Parameters
 namespace MVS
 {
+	//logistic model of treatment uptake, coefficients of the covariates
+	struct UptakeModel
+	{
+		double intercept;
+		double male, black, hispanic, other;
+		double age_35_64, age_65_;
+		double prior; //prior treatment of the same type
+	};
+
 	struct ViolenceParams
 	{
 		int inner_draws, outer_draws;
@@ -58,6 +110,9 @@ namespace MVS
 		double percent_relapse;
 		double dw_mild, dw_moderate, dw_severe;
 		double discount;
+
+		//[UPTAKE_PRIOR or UPTAKE_REFERRED][PTSD non-case (0) or case (1)][CBT (0) or SPR (1)]
+		UptakeModel uptake[2][2][2];
 	};
 }
 
@@ -88,6 +143,7 @@ public:
 
 	typedef std::map<std::string, int> MapInt;
 	typedef std::map<std::string, double>MapDbl;
+	typedef std::map<std::string, std::string> MapStr;
 	typedef std::multimap<int, MapInt> MultiMapCB;
 	typedef std::map<std::string, std::vector<PairDD>> ProbMap;
 	typedef std::map<std::string, PairDD> PairMap;
@@ -101,6 +157,11 @@ public:
 
 	std::string getInputDir() const;
 	std::string getOutputDir() const;
+	static void createDirectory(const std::string &);
+	void setOutputDir(const std::string &);
+	void setSeed(unsigned int);
+	std::string getGofLogFile() const;
+	std::string getGofLogFile(int, int) const;
 	
 	const char* getMSAListFile();
 	const char* getCountiesListFile();
@@ -120,10 +181,15 @@ public:
 	double getMinSampleSize() const;
 	int getMaxDraws() const;
 	short int getSimType() const;
+	void setSimType(int);
 	bool writeToFile() const;
 
+	void setRunParams(const MapStr *);
+	const RunParams *getRunParam() const;
+
 	const Pool *getHouseholdPool() const;
 	const Pool *getPersonPool() const;
+	int getPersonPoolIndex(const std::string &) const;
 	const Pool *getNhanesPool() const;
 
 	MultiMapCB getACSCodeBook() const;
@@ -137,6 +203,7 @@ public:
 	PairMap *getPtsdSymptoms();
 	//double getMassViolenceParam(std::string);
 	const MVS::ViolenceParams *getViolenceParam();
+	bool setViolenceParam(const std::string &, double);
 	const EET::CardioParams *getCardioParam();
 	
 private:
@@ -145,6 +212,7 @@ private:
 	void readAgeGenderMappingFile();
 	void readHHIncomeMappingFile();
 	void readOriginListFile();
+	void readModelInputs();
 
 	//Equity-efficiency model
 	void readNHANESRiskFactors();
@@ -157,6 +225,7 @@ private:
 	void readSchoolDemograhics();
 	void readMassViolenceInputs();
 	void readPtsdSymptoms();
+	void readTreatmentUptake();
 	void setViolenceParams(MapDbl *);
 
 	void createHouseholdPool();
@@ -170,28 +239,39 @@ private:
 	Rows readCSVFile(const char*);
 
 	const char *inputDir;
-	const char *outputDir;
+	std::string outputDir;
 
-	MultiMapCSV m_codeBook;
-	MultiMapCB m_acsCodes;
+	//input tables: read once and shared, read-only, by copies of the parameters
+	struct Inputs
+	{
+		MultiMapCSV m_codeBook;
+		MultiMapCB m_acsCodes;
 
-	std::multimap<int, int> m_eduAgeGender;
-	std::multimap<int, int> m_hhIncome;
+		std::multimap<int, int> m_eduAgeGender;
+		std::multimap<int, int> m_hhIncome;
 
-	MapInt m_originByRace, m_schoolDemo;
-	MVS::ViolenceParams vParams;
-	PairMap m_ptsdx;
+		MapInt m_originByRace, m_schoolDemo;
+		PairMap m_ptsdx;
 
-	ProbMap m_riskStrataProb;
-	RiskFacMap m_risks;//, m_risk_ci;
+		ProbMap m_riskStrataProb;
+		RiskFacMap m_risks;//, m_risk_ci;
+
+		Pool hhPool, personPool, nhanesPool;
+		std::map<std::string, int> personPoolIndex; //position of person type in personPool
+	};
+
+	MVS::ViolenceParams vParams;
+	MapDbl m_violenceInputs;
 	EET::CardioParams cardioParams;
 
 	double alpha, minSampleSize;
 	int max_draws;
 	short int simType;
 	bool output;
+	bool cardioInputs, violenceInputs; //model inputs already read
+	RunParams runParams;
 
-	Pool hhPool, personPool, nhanesPool;
+	std::shared_ptr<Inputs> inputs;
 
 };
 #endif __Parameters_h__
\ No newline at end of file
@@ -30,6 +30,26 @@ void PersonPums::setSocialCharacters(std::string p_education, std::string p_mari
 {
 	setEduAgeCat();
 	setEducation(to_number<short int>(p_education));
+	setPersonTypes();
+}
+
+/**
+*	@brief Looks up person types of the IPF/IPU constraints once per PUMS record
+*	(sex-age-origin, and sex-age-origin-education for adults), so that drawn persons
+*	are counted by index
+*	@return void
+*/
+void PersonPums::setPersonTypes()
+{
+	std::string dummy = "0";
+	std::string p_sex = std::to_string(sex);
+	std::string p_origin = std::to_string(originByRace);
+
+	personType = parameters->getPersonPoolIndex(dummy+p_sex+std::to_string(ageCat)+p_origin);
+
+	eduPersonType = -1;
+	if(age >= 18)
+		eduPersonType = parameters->getPersonPoolIndex(p_sex+std::to_string(eduAgeCat)+p_origin+std::to_string(education));
 }
 
 void PersonPums::setAge(short int p_age)
@@ -241,6 +261,16 @@ short int PersonPums::getEduAgeCat() const
 	return eduAgeCat;
 }
 
+int PersonPums::getPersonType() const
+{
+	return personType;
+}
+
+int PersonPums::getEduPersonType() const
+{
+	return eduPersonType;
+}
+
 
 template<class T>
 T PersonPums::to_number(const std::string &data)
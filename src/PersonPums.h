@@ -37,6 +37,8 @@ public:
 	short int getOrigin() const;
 	short int getEducation() const;
 	short int getEduAgeCat() const;
+	int getPersonType() const;
+	int getEduPersonType() const;
 
 private:
 
@@ -48,6 +50,7 @@ private:
 	void setOrigin();
 	void setEducation(short int);
 	void setEduAgeCat();
+	void setPersonTypes();
 
 	template<class T>
 	T to_number(const std::string &);
@@ -59,6 +62,7 @@ private:
 	short int age, ageCat, sex;
 	short int race, ethnicity, originByRace; 
 	short int education, eduAgeCat;
+	int personType, eduPersonType; //person pool indices of IPF/IPU constraints, -1 if none
 };
 
 #endif __PersonPums_h__
@@ -30,6 +30,11 @@ PopBrewer::PopBrewer(Parameters *param) : parameters(param)
 	
 }
 
+PopBrewer::PopBrewer(std::shared_ptr<Parameters> param) : parameters(param)
+{
+
+}
+
 PopBrewer::~PopBrewer()
 {
 	std::cout << "Pop Brewer destructor!" << std::endl;
@@ -40,12 +45,142 @@ void PopBrewer::setParameters(const Parameters &param)
 	parameters = std::make_shared<Parameters>(param);
 }
 
+std::shared_ptr<Parameters> PopBrewer::getParameters() const
+{
+	return parameters;
+}
+
 void PopBrewer::import()
 {
 	importMetroArea();
 	importEstimates();
 }
 
+/**
+*	@brief Returns MSAs selected with "--msa", largest population first. Ties are
+*	ordered by geoID so that the order is deterministic.
+*	@param selected is list of MSA ids (empty: default MSA)
+*	@param defaultMSA is MSA used if none are selected ("" selects all MSAs)
+*	@return list of selected MSAs
+*/
+std::vector<Metro*> PopBrewer::getSelectedMetros(const std::string &defaultMSA)
+{
+	return getSelectedMetros(parameters->getRunParam()->msa_list, defaultMSA);
+}
+
+std::vector<Metro*> PopBrewer::getSelectedMetros(const std::vector<std::string> &selected, const std::string &defaultMSA)
+{
+	std::vector<std::string> msaList = selected;
+	if(msaList.empty() && !defaultMSA.empty())
+		msaList.push_back(defaultMSA);
+
+	std::vector<Metro*> metros;
+	if(msaList.empty())
+	{
+		for(auto metro = metroAreas.begin(); metro != metroAreas.end(); ++metro)
+			metros.push_back(&metro->second);
+	}
+	else
+	{
+		for(auto id = msaList.begin(); id != msaList.end(); ++id)
+		{
+			if(metroAreas.count(*id) == 0)
+			{
+				std::cout << "Error: MSA " << *id << " doesn't exist in MSA List file!" << std::endl;
+				exit(EXIT_SUCCESS);
+			}
+			metros.push_back(&metroAreas.at(*id));
+		}
+	}
+
+	std::stable_sort(metros.begin(), metros.end(), [](const Metro *a, const Metro *b)
+	{
+		if(a->getPopulation() != b->getPopulation())
+			return a->getPopulation() > b->getPopulation();
+		return a->getGeoID() < b->getGeoID();
+	});
+
+	return metros;
+}
+
+/**
+*	@brief Splits MSAs across N shards ("--shard=i/N") and returns those of this 
+*	shard. MSAs, largest population first, are assigned to the shard with the 
+*	smallest total population so far (lowest shard index on ties); the split only
+*	depends on the MSA list, so that every shard process computes the same split.
+*	@param metros is list of MSAs ordered by population (see getSelectedMetros)
+*	@return MSAs of this shard in the same order
+*/
+std::vector<Metro*> PopBrewer::getShardMetros(const std::vector<Metro*> &metros) const
+{
+	int num_shards = parameters->getRunParam()->num_shards;
+	int shard_id = parameters->getRunParam()->shard_id;
+	if(num_shards <= 1)
+		return metros;
+
+	std::vector<long long> shardPop(num_shards, 0);
+	std::vector<Metro*> shardMetros;
+	for(auto metro = metros.begin(); metro != metros.end(); ++metro)
+	{
+		int shard = (int)(std::min_element(shardPop.begin(), shardPop.end())-shardPop.begin());
+		shardPop[shard] += (*metro)->getPopulation();
+
+		if(shard == shard_id)
+			shardMetros.push_back(*metro);
+	}
+
+	std::cout << "Shard " << shard_id << " of " << num_shards << ": " << shardMetros.size() << " MSAs, population " 
+		<< shardPop[shard_id] << std::endl;
+
+	return shardMetros;
+}
+
+/**
+*	@brief Merges fit logs of N finished shards into gofLog.txt. Records are ordered
+*	by MSA geoID (keeping the order of records within an MSA), which is the order 
+*	of a single run. Per-MSA output files of shards are already distinct.
+*	@param param is parameters of the run (number of shards)
+*	@return void
+*/
+void PopBrewer::mergeShards(const Parameters *param)
+{
+	int num_shards = param->getRunParam()->merge_shards;
+
+	std::vector<std::pair<std::string, std::string>> records;
+	for(int i = 0; i < num_shards; ++i)
+	{
+		std::string fileName = param->getGofLogFile(i, num_shards);
+		std::ifstream shardLog(fileName);
+		if(!shardLog.is_open())
+		{
+			std::cout << "Error: Cannot open " << fileName << "! Has shard " << i << " finished?" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		std::string line;
+		while(std::getline(shardLog, line))
+		{
+			if(!line.empty())
+				records.push_back(std::make_pair(line.substr(0, line.find(',')), line));
+		}
+	}
+
+	std::stable_sort(records.begin(), records.end(), 
+		[](const std::pair<std::string, std::string> &a, const std::pair<std::string, std::string> &b){ return a.first < b.first; });
+
+	std::ofstream logFile("gofLog.txt", std::ios::app);
+	if(!logFile.is_open())
+	{
+		std::cout << "Error: Cannot open gofLog.txt!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	for(auto rec = records.begin(); rec != records.end(); ++rec)
+		logFile << rec->second << std::endl;
+
+	std::cout << "Merged " << records.size() << " fit records of " << num_shards << " shards into gofLog.txt" << std::endl;
+}
+
 /**
 *	@brief Imports, iterates through list of MSA and pairs MSAs with their counties 
 *	and PUMA codes
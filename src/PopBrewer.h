@@ -8,6 +8,7 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <boost/tokenizer.hpp>
 //#include <unordered_map>
 
@@ -29,11 +30,19 @@ public:
 	
 	PopBrewer();
 	PopBrewer(Parameters *);
+	PopBrewer(std::shared_ptr<Parameters>);
 	virtual ~PopBrewer();
 
 	void setParameters(const Parameters &);
+	std::shared_ptr<Parameters> getParameters() const;
 	void import();
 
+	std::vector<Metro*> getSelectedMetros(const std::string &);
+	std::vector<Metro*> getSelectedMetros(const std::vector<std::string> &, const std::string &);
+	std::vector<Metro*> getShardMetros(const std::vector<Metro*> &) const;
+
+	static void mergeShards(const Parameters *);
+
 protected:
 	std::shared_ptr<Parameters>parameters;
 
@@ -0,0 +1,363 @@
+#include "PopDaemon.h"
+#include "Metro.h"
+#include "Counter.h"
+#include "AgentSink.h"
+#include "CardioModel.h"
+#include "Random.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+#endif
+
+PopDaemon::PopDaemon() : serverFd(-1), stopping(false)
+{
+}
+
+PopDaemon::~PopDaemon()
+{
+}
+
+/**
+*	@brief Listens on a Unix socket and serves requests until a shutdown request
+*	arrives. Connections are queued and served by --threads worker threads.
+*	@param path is file path of the socket
+*	@return void
+*/
+void PopDaemon::serve(const std::string &path)
+{
+#ifdef _WIN32
+	std::cout << "Error: Daemon mode requires Unix domain sockets!" << std::endl;
+	exit(EXIT_SUCCESS);
+#else
+	sockaddr_un addr;
+	if(path.size() >= sizeof(addr.sun_path))
+	{
+		std::cout << "Error: Socket path " << path << " is too long!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	socketPath = path;
+	unlink(socketPath.c_str());
+
+	serverFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path)-1);
+
+	if(serverFd < 0 || bind(serverFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(serverFd, SOMAXCONN) < 0)
+	{
+		std::cout << "Error: Cannot listen on " << socketPath << "!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	int num_workers = parameters->getRunParam()->num_threads;
+	if(num_workers <= 0)
+		num_workers = std::max(1, (int)std::thread::hardware_concurrency());
+
+	std::vector<std::thread> workers;
+	for(int i = 0; i < num_workers; ++i)
+		workers.push_back(std::thread(&PopDaemon::work, this));
+
+	std::cout << "Serving requests on " << socketPath << " (" << num_workers << " workers)" << std::endl;
+
+	while(!stopping)
+	{
+		int fd = accept(serverFd, NULL, NULL);
+		if(fd < 0)
+			continue;
+
+		std::lock_guard<std::mutex> lock(connLock);
+		connections.push_back(fd);
+		connReady.notify_one();
+	}
+
+	//ends reads of connections being served, so that workers blocked on idle
+	//clients return once their running request is answered
+	{
+		std::lock_guard<std::mutex> lock(connLock);
+		for(auto fd = clients.begin(); fd != clients.end(); ++fd)
+			shutdown(*fd, SHUT_RD);
+	}
+
+	connReady.notify_all();
+	for(auto t = workers.begin(); t != workers.end(); ++t)
+		t->join();
+
+	close(serverFd);
+	unlink(socketPath.c_str());
+	std::cout << "Daemon stopped" << std::endl;
+#endif
+}
+
+void PopDaemon::work()
+{
+	while(true)
+	{
+		int fd;
+		{
+			std::unique_lock<std::mutex> lock(connLock);
+			connReady.wait(lock, [&]{ return stopping || !connections.empty(); });
+			if(connections.empty())
+				return;
+
+			fd = connections.front();
+			connections.pop_front();
+
+			//connections queued at shutdown are closed without being served
+			if(stopping)
+			{
+#ifndef _WIN32
+				close(fd);
+#endif
+				continue;
+			}
+			clients.insert(fd);
+		}
+		handle(fd);
+	}
+}
+
+/**
+*	@brief Answers every request line of a connection until the client closes it
+*	@param fd is connection socket
+*	@return void
+*/
+void PopDaemon::handle(int fd)
+{
+#ifndef _WIN32
+	std::string line;
+	while(readLine(fd, line))
+	{
+		if(line == "shutdown")
+		{
+			stopping = true;
+			writeLine(fd, "ok shutdown");
+
+			//wakes the accept loop
+			int wake = socket(AF_UNIX, SOCK_STREAM, 0);
+			sockaddr_un addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path)-1);
+			connect(wake, (sockaddr*)&addr, sizeof(addr));
+			close(wake);
+			break;
+		}
+
+		if(!line.empty())
+			writeLine(fd, process(line));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(connLock);
+		clients.erase(fd);
+	}
+	close(fd);
+#endif
+}
+
+std::string PopDaemon::process(const std::string &line)
+{
+	Request req;
+	std::string error;
+	if(!parseRequest(line, req, error))
+		return "error " + error;
+
+	auto metro = metroAreas.find(req.msa);
+	if(metro == metroAreas.end())
+		return "error unknown msa " + req.msa;
+
+	Timings timings = {0, 0, 0, 0};
+	TimePoint start = std::chrono::steady_clock::now();
+	std::string reply = runRequest(&metro->second, req, timings);
+	timings.total_ms = ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1) << reply << " wait_ms=" << timings.wait_ms << " ipu_ms=" << timings.ipu_ms
+		<< " draw_ms=" << timings.draw_ms << " total_ms=" << timings.total_ms;
+
+	std::cout << out.str() << std::endl;
+	return out.str();
+}
+
+bool PopDaemon::parseRequest(const std::string &line, Request &req, std::string &error) const
+{
+	req.seed = parameters->getRunParam()->seed;
+	req.model = DAEMON_MODEL_EET;
+	req.out = parameters->getOutputDir();
+
+	std::istringstream fields(line);
+	std::string field;
+	while(fields >> field)
+	{
+		size_t eq = field.find('=');
+		if(eq == std::string::npos)
+		{
+			error = "malformed field " + field;
+			return false;
+		}
+
+		std::string key = field.substr(0, eq), val = field.substr(eq+1);
+		if(key == "msa")
+			req.msa = val;
+		else if(key == "seed")
+		{
+			try {
+				req.seed = (unsigned int)std::stoul(val);
+			}
+			catch(const std::exception &) {
+				error = "invalid seed " + val;
+				return false;
+			}
+		}
+		else if(key == "model")
+			req.model = val;
+		else if(key == "out")
+		{
+			if(val.empty())
+			{
+				error = "empty out";
+				return false;
+			}
+			req.out = (val.back() == '/') ? val : val+"/";
+		}
+		else
+		{
+			error = "unknown field " + key;
+			return false;
+		}
+	}
+
+	if(req.msa.empty())
+	{
+		error = "missing msa";
+		return false;
+	}
+
+	if(req.model != DAEMON_MODEL_EET && req.model != DAEMON_MODEL_FILE && req.model != DAEMON_MODEL_COUNTS)
+	{
+		error = "unknown model " + req.model;
+		return false;
+	}
+	return true;
+}
+
+/**
+*	@brief Solves IPU of the MSA on its first request (cache miss) and draws the
+*	population of the request with its own seed and output directory. Draws of 
+*	the same MSA run concurrently on the shared IPU solution, except draws into the
+*	same output directory, which write the same files and run one at a time.
+*	Requests share the input tables of the parameters; only run options and the
+*	output directory are set per request.
+*	@param metro is requested MSA
+*	@param req is request
+*	@param timings receives wait, IPU and draw times
+*	@return status of the reply
+*/
+std::string PopDaemon::runRequest(Metro *metro, const Request &req, Timings &timings)
+{
+	bool cached;
+	{
+		TimePoint start = std::chrono::steady_clock::now();
+		std::lock_guard<std::mutex> lock(getLock(metroLocks, req.msa));
+		TimePoint locked = std::chrono::steady_clock::now();
+		timings.wait_ms = ElapsedTime::elapsed_ms(start, locked);
+
+		cached = metro->isIPUSolved();
+		if(!cached)
+			metro->solveIPU();
+		timings.ipu_ms = ElapsedTime::elapsed_ms(locked, std::chrono::steady_clock::now());
+	}
+
+	TimePoint waiting = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> outputLock(getLock(outputLocks, req.msa+" "+req.out));
+	timings.wait_ms += ElapsedTime::elapsed_ms(waiting, std::chrono::steady_clock::now());
+
+	std::shared_ptr<Parameters> reqParams = std::make_shared<Parameters>(*parameters);
+	reqParams->setOutputDir(req.out);
+	reqParams->setSeed(req.seed);
+
+	Random random(req.seed, req.msa, 0, RNG_PHASE_DRAW);
+	std::ostringstream reply;
+	reply << "ok msa=" << req.msa << " model=" << req.model << " seed=" << req.seed << " cache=" << (cached ? "hit" : "miss");
+
+	TimePoint start = std::chrono::steady_clock::now();
+	if(req.model == DAEMON_MODEL_EET)
+	{
+		CardioModel model(reqParams);
+		model.runMetro(metro, random);
+	}
+	else
+	{
+		Counter counter(reqParams);
+		if(req.model == DAEMON_MODEL_FILE)
+		{
+			BinaryFileSink sink(&counter, req.out+"agents/"+req.msa+"_"+std::to_string(req.seed)+"_agents.bin");
+			metro->generateAgents(&sink, random);
+			reply << " records=" << sink.getRecordCount();
+		}
+		else
+		{
+			CountSink sink(&counter);
+			metro->generateAgents(&sink, random);
+			counter.outputHouseholdCounts(req.msa);
+			counter.outputPersonCounts(req.msa);
+		}
+	}
+	timings.draw_ms = ElapsedTime::elapsed_ms(start, std::chrono::steady_clock::now());
+
+	metro->writeGofLog();
+	return reply.str();
+}
+
+std::mutex & PopDaemon::getLock(std::map<std::string, std::unique_ptr<std::mutex>> &locks, const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(locksLock);
+	std::unique_ptr<std::mutex> &keyLock = locks[key];
+	if(!keyLock)
+		keyLock.reset(new std::mutex);
+
+	return *keyLock;
+}
+
+bool PopDaemon::readLine(int fd, std::string &line) const
+{
+	line.clear();
+#ifndef _WIN32
+	char c;
+	while(read(fd, &c, 1) == 1)
+	{
+		if(c == '\n')
+		{
+			if(!line.empty() && line.back() == '\r')
+				line.pop_back();
+			return true;
+		}
+
+		if(line.size() >= DAEMON_MAX_REQUEST)
+			return false;
+		line += c;
+	}
+#endif
+	return !line.empty();
+}
+
+void PopDaemon::writeLine(int fd, const std::string &line) const
+{
+#ifndef _WIN32
+	std::string msg = line + "\n";
+	size_t sent = 0;
+	while(sent < msg.size())
+	{
+		ssize_t n = write(fd, msg.data()+sent, msg.size()-sent);
+		if(n <= 0)
+			return;
+		sent += n;
+	}
+#endif
+}
@@ -0,0 +1,94 @@
+#ifndef __PopDaemon_h__
+#define __PopDaemon_h__
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "PopBrewer.h"
+#include "ElapsedTime.h"
+
+#define DAEMON_MODEL_EET "eet"
+#define DAEMON_MODEL_FILE "file"
+#define DAEMON_MODEL_COUNTS "counts"
+
+#define DAEMON_MAX_REQUEST 4096
+
+class Metro;
+
+/**
+*	@brief Long-running population server on a local Unix socket. Parameters and
+*	ACS marginals are imported once at startup, and the PUMS records and IPU 
+*	solution of an MSA are kept after its first request, so later requests only
+*	draw households. Requests are one line each:
+*		msa=<id> [seed=<S>] [model=eet|file|counts] [out=<path>]
+*	and are served concurrently by a fixed set of worker threads. Requests with the
+*	same MSA and output directory write the same files and are served one at a
+*	time. Each request is answered with one line, "ok ..." with its timings or
+*	"error <reason>". The line "shutdown" stops the server once running requests
+*	have completed; idle connections are closed.
+*/
+class PopDaemon : public PopBrewer
+{
+public:
+	PopDaemon();
+	virtual ~PopDaemon();
+
+	void serve(const std::string &);
+
+private:
+	//parsed request line
+	struct Request
+	{
+		std::string msa;
+		unsigned int seed;
+		std::string model;
+		std::string out;
+	};
+
+	//time spent on a request: waiting for the MSA and output locks, IPU (cache miss) and drawing
+	struct Timings
+	{
+		double wait_ms;
+		double ipu_ms;
+		double draw_ms;
+		double total_ms;
+	};
+
+	void work();
+	void handle(int);
+	std::string process(const std::string &);
+	bool parseRequest(const std::string &, Request &, std::string &) const;
+	std::string runRequest(Metro *, const Request &, Timings &);
+
+	std::mutex & getLock(std::map<std::string, std::unique_ptr<std::mutex>> &, const std::string &);
+
+	bool readLine(int, std::string &) const;
+	void writeLine(int, const std::string &) const;
+
+	int serverFd;
+	std::string socketPath;
+	std::atomic<bool> stopping;
+
+	std::deque<int> connections;
+	std::set<int> clients; //connections being served
+	std::mutex connLock;
+	std::condition_variable connReady;
+
+	std::map<std::string, std::unique_ptr<std::mutex>> metroLocks; //IPU of an MSA
+	std::map<std::string, std::unique_ptr<std::mutex>> outputLocks; //draws of an MSA into an output directory
+	std::mutex locksLock;
+};
+
+#endif __PopDaemon_h__
@@ -0,0 +1,750 @@
+#include "PtsdState.h"
+#include "Parameters.h"
+#include "ACS.h"
+#include "Random.h"
+#include "Counter.h"
+
+#include <algorithm>
+
+PtsdState::PtsdState() : param(NULL)
+{
+}
+
+PtsdState::~PtsdState()
+{
+}
+
+void PtsdState::setParameters(const MVS::ViolenceParams *p)
+{
+	param = p;
+	createUptakeTable();
+}
+
+/**
+*	@brief Tabulates probabilities of treatment uptake for every uptake model and 
+*	prior treatment and every covariate code
+*	@return void
+*/
+void PtsdState::createUptakeTable()
+{
+	for(int i = 0; i < 2; ++i)
+	{
+		for(int j = 0; j < NUM_CASES; ++j)
+		{
+			for(int k = 0; k < 2; ++k)
+			{
+				const MVS::UptakeModel *m = &param->uptake[i][j][k];
+				for(int prior = 0; prior < 2; ++prior)
+				{
+					for(int code = 0; code < NUM_COVARIATE_CODES; ++code)
+					{
+						int male = code/12;
+						int origin = (code/3)%4;
+						int age = code%3;
+
+						double log = m->intercept + (m->male*male) + (m->black*(origin == 1)) + (m->hispanic*(origin == 2)) 
+							+ (m->other*(origin == 3)) + (m->age_35_64*(age == 1)) + (m->age_65_*(age == 2)) + (m->prior*prior);
+
+						//referred uptake: zero logit is no uptake
+						if(i == UPTAKE_REFERRED && log == 0.0)
+							uptakeProb[i][j][k][prior][code] = 0.0;
+						else
+							uptakeProb[i][j][k][prior][code] = exp(log)/(1+exp(log));
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+*	@brief Packs covariates of treatment uptake into a code (0 to NUM_COVARIATE_CODES-1)
+*	@param sex is sex
+*	@param ageCat is age category (Violence::AgeCat)
+*	@param newOrigin is origin (Violence::Origin)
+*	@return covariate code
+*/
+int PtsdState::getCovariateCode(int sex, int ageCat, int newOrigin)
+{
+	int male = (sex == Violence::Sex::Male) ? 1 : 0;
+
+	int origin = 0;
+	if(newOrigin == Violence::Origin::BlackNH)
+		origin = 1;
+	else if(newOrigin == Violence::Origin::Hisp)
+		origin = 2;
+	else if(newOrigin == Violence::Origin::OtherNH)
+		origin = 3;
+
+	int age = 0;
+	if(ageCat == Violence::AgeCat::Age_35_64)
+		age = 1;
+	else if(ageCat == Violence::AgeCat::Age_65_)
+		age = 2;
+
+	return (male*4+origin)*3+age;
+}
+
+/**
+*	@brief Adds an agent without PTSD symptoms and sets its covariates of treatment
+*	uptake. Agents are added in ID order.
+*	@param id is agent ID
+*	@param sex is sex
+*	@param ageCat is age category (Violence::AgeCat)
+*	@param newOrigin is origin (Violence::Origin)
+*	@return void
+*/
+void PtsdState::addAgent(int id, int sex, int ageCat, int newOrigin)
+{
+	size_t num = (size_t)id+1;
+	if(initPtsdx.size() < num)
+	{
+		covariates.resize(num);
+
+		initPtsdx.resize(num);
+		ptsdStatus.resize(num);
+		priorCBT.resize(num);
+		priorSPR.resize(num);
+		cbtReferred.resize(num);
+		sprReferred.resize(num);
+
+		for(int i = 0; i < NUM_TREATMENT; ++i)
+		{
+			ptsdx[i].resize(num);
+			ptsdTime[i].resize(num);
+			durMild[i].resize(num);
+			durMod[i].resize(num);
+			durSevere[i].resize(num);
+
+			curCBT[i].resize(num);
+			curSPR[i].resize(num);
+			sessionsCBT[i].resize(num);
+			sessionsSPR[i].resize(num);
+
+			numRelapse[i].resize(num);
+			relapseTimer[i].resize(num);
+
+			isResolved[i].resize(num);
+			resolvedTime[i].resize(num);
+		}
+	}
+
+	covariates[id] = (uint8_t)getCovariateCode(sex, ageCat, newOrigin);
+
+	reset(id, 0.0);
+}
+
+void PtsdState::clear()
+{
+	PtsdState empty;
+	empty.param = param;
+	*this = empty;
+}
+
+/**
+*	@brief Resets PTSD, treatment, relapse and resolution variables of an agent to
+*	those of a new agent with PTSD symptoms ptsdx_
+*	@param id is agent ID
+*	@param ptsdx_ is PTSD symptoms
+*	@return void
+*/
+void PtsdState::reset(int id, double ptsdx_)
+{
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		ptsdx[i][id] = ptsdx_;
+		ptsdTime[i][id] = 0;
+		durMild[i][id] = 0;
+		durMod[i][id] = 0;
+		durSevere[i][id] = 0;
+
+		curCBT[i][id] = false;
+		curSPR[i][id] = false;
+		sessionsCBT[i][id] = 0;
+		sessionsSPR[i][id] = 0;
+
+		isResolved[i][id] = false;
+		resolvedTime[i][id] = 0;
+		numRelapse[i][id] = 0;
+		relapseTimer[i][id] = 0;
+	}
+
+	initPtsdx[id] = ptsdx_;
+	ptsdStatus[id] = 0;
+
+	priorCBT[id] = 0;
+	priorSPR[id] = 0;
+	cbtReferred[id] = false;
+	sprReferred[id] = false;
+}
+
+void PtsdState::setPtsdStatus(int id, int type)
+{
+	ptsdStatus[id] |= (uint8_t)(1 << type);
+}
+
+/**
+*	@brief Draws PTSD symptoms of an agent from the symptom distribution of its
+*	stratum; agents with PTSD are redrawn until their symptoms reach the cut-off
+*	@param id is agent ID
+*	@param pair_ptsdx is mean and standard deviation of symptoms
+*	@param random is random stream
+*	@return void
+*/
+void PtsdState::setSymptoms(int id, const PairDD &pair_ptsdx, Random *random)
+{
+	bool ptsd_status = (ptsdStatus[id] != 0);
+	double cutoff = getPtsdCutOff();
+	double ptsdx_ = random->normal_dist(pair_ptsdx.first, pair_ptsdx.second);
+
+	if(ptsdx_ >= cutoff)
+	{
+		if(ptsdx_ >  MAX_PTSDX)
+			ptsdx_ = MAX_PTSDX;
+
+		if(!ptsd_status)
+			ptsdx_ = cutoff-1;
+	}
+	else
+	{
+		if(ptsdx_ < MIN_PTSDX)
+			ptsdx_ = MIN_PTSDX;
+
+		if(ptsd_status)
+		{
+			while(true)
+			{
+				ptsdx_ = random->normal_dist(pair_ptsdx.first, pair_ptsdx.second);
+				if(ptsdx_ > MAX_PTSDX)
+					ptsdx_ = MAX_PTSDX;
+
+				//add to parameters files - secondary and tertiary PTSD coeffs
+				if(getPTSDstatus(id, SECONDARY))
+					ptsdx_ = 0.9*ptsdx_;
+				else if(getPTSDstatus(id, TERTIARY))
+					ptsdx_ = 0.85*ptsdx_;
+
+				if(ptsdx_ >= cutoff)
+					break;
+			}
+		}
+	}
+
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		ptsdx[i][id] = ptsdx_;
+
+	initPtsdx[id] = ptsdx_;
+}
+
+/**
+*	@brief Schedules a block of agents for a trial: agents with PTSD symptoms make
+*	up the active set and are scheduled for prior treatment (tick 0) and screening
+*	(screening_time).
+*	@param schedule is schedule of the block
+*	@param ids is list of agent IDs of the block
+*	@param num is number of agents
+*	@param num_ticks is number of ticks of the trial
+*	@return void
+*/
+void PtsdState::schedule(PtsdSchedule *schedule, const int *ids, size_t num, int num_ticks) const
+{
+	schedule->active.clear();
+	for(size_t k = 0; k < num; ++k)
+	{
+		if(initPtsdx[ids[k]] != 0.0)
+			schedule->active.push_back(ids[k]);
+	}
+
+	for(int e = 0; e < NUM_EVENTS; ++e)
+		schedule->events[e].assign(num_ticks, std::vector<int>());
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		schedule->relapsing[i].clear();
+
+	if(num_ticks > 0)
+		schedule->events[EVENT_PRIOR_UPTAKE][0] = schedule->active;
+	if(param->screening_time >= 0 && param->screening_time < num_ticks)
+		schedule->events[EVENT_SCREENING][param->screening_time] = schedule->active;
+}
+
+/**
+*	@brief Runs the rules of a tick on the agents of a schedule, in the order the
+*	rules apply to an agent: prior treatment and screening (events of the tick)
+*	and, per treatment arm, treatment, symptom resolution and relapse. Each rule
+*	is one loop over its agents. Treatment is provided only while treatment can
+*	start; relapse runs only on agents past their relapse time. Agents that can
+*	no longer change state leave the active set at the end of the tick.
+*	@param tick is tick
+*	@param schedule is schedule of the agents
+*	@param random is random stream of the agents
+*	@param counter is counter (shard) of the agents
+*	@return void
+*/
+void PtsdState::runTick(int tick, PtsdSchedule *schedule, Random *random, Counter *counter)
+{
+	const std::vector<int> *events;
+
+	if((events = schedule->getEvents(EVENT_PRIOR_UPTAKE, tick)) != NULL)
+		priorTreatmentUptake(events->data(), events->size(), random);
+
+	if((events = schedule->getEvents(EVENT_SCREENING, tick)) != NULL)
+		ptsdScreeningSteppedCare(events->data(), events->size(), random, counter);
+
+	bool treating = (tick >= param->screening_time && tick < getTreatmentEnd());
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		if(treating)
+			provideTreatment(tick, i, schedule->active.data(), schedule->active.size(), random, counter);
+		symptomResolution(tick, i, schedule, random, counter);
+		symptomRelapse(tick, i, schedule, random);
+	}
+
+	std::vector<int> &active = schedule->active;
+	active.erase(std::remove_if(active.begin(), active.end(), [this](int id) { return !isActive(id); }), active.end());
+}
+
+/**
+*	@brief Adds an agent to the events of a tick; events past the last tick are dropped
+*	@param event is event (EVENT_PRIOR_UPTAKE, EVENT_SCREENING or EVENT_RELAPSE+treatment arm)
+*	@param tick is tick of the event
+*	@param id is agent ID
+*	@return void
+*/
+void PtsdSchedule::push(int event, int tick, int id)
+{
+	if(tick >= 0 && tick < (int)events[event].size())
+		events[event][tick].push_back(id);
+}
+
+/**
+*	@brief Returns agents with an event at a tick
+*	@param event is event
+*	@param tick is tick
+*	@return list of agent IDs, NULL if there are none
+*/
+const std::vector<int> * PtsdSchedule::getEvents(int event, int tick) const
+{
+	if(tick < 0 || tick >= (int)events[event].size() || events[event][tick].empty())
+		return NULL;
+	return &events[event][tick];
+}
+
+void PtsdState::priorTreatmentUptake(const int *ids, size_t num, Random *random)
+{
+	double cutoff = getPtsdCutOff();
+	for(size_t k = 0; k < num; ++k)
+	{
+		int id = ids[k];
+		int ptsd_case = (initPtsdx[id] >= cutoff) ? PTSD_CASE : PTSD_NON_CASE;
+
+		double pCBT = uptakeProb[UPTAKE_PRIOR][ptsd_case][CBT][0][covariates[id]];
+		double pSPR = uptakeProb[UPTAKE_PRIOR][ptsd_case][SPR][0][covariates[id]];
+
+		double randomCBT = random->uniform_real_dist();
+		priorCBT[id] = (randomCBT < pCBT) ? 1 : 0;
+
+		double randomSPR = random->uniform_real_dist();
+		priorSPR[id] = (randomSPR < pSPR) ? 1 : 0;
+	}
+}
+
+void PtsdState::ptsdScreeningSteppedCare(const int *ids, size_t num, Random *random, Counter *counter)
+{
+	double cutoff = getPtsdCutOff();
+	for(size_t k = 0; k < num; ++k)
+	{
+		int id = ids[k];
+		if(initPtsdx[id] >= cutoff)
+		{
+			double randomP1 = random->uniform_real_dist();
+			if(randomP1 < param->sensitivity)
+			{
+				cbtReferred[id] = true;
+				sprReferred[id] = false;
+			}
+			else
+			{
+				cbtReferred[id] = false;
+				sprReferred[id] = true;
+			}
+		}
+		else if(initPtsdx[id] < cutoff)
+		{
+			double randomP2 = random->uniform_real_dist();
+			double specificity = 1 - param->specificity;
+			if(randomP2 < specificity)
+			{
+				cbtReferred[id] = true;
+				sprReferred[id] = false;
+
+				counter->addCbtReferredNonPtsd();
+			}
+			else
+			{
+				cbtReferred[id] = false;
+				sprReferred[id] = true;
+			}
+		}
+	}
+}
+
+void PtsdState::provideTreatment(int tick, int treatment, const int *ids, size_t num, Random *random, Counter *counter)
+{
+	if(treatment == STEPPED_CARE)
+	{
+		for(size_t k = 0; k < num; ++k)
+		{
+			int id = ids[k];
+			if(cbtReferred[id] && !sprReferred[id])
+				provideCBT(id, tick, STEPPED_CARE, random, counter);
+			else if(!cbtReferred[id] && sprReferred[id])
+				provideSPR(id, tick, STEPPED_CARE, random, counter);
+		}
+	}
+	else if(treatment == USUAL_CARE)
+	{
+		for(size_t k = 0; k < num; ++k)
+			provideSPR(ids[k], tick, USUAL_CARE, random, counter);
+	}
+}
+
+void PtsdState::symptomResolution(int tick, int treatment, PtsdSchedule *schedule, Random *random, Counter *counter)
+{
+	double cutoff = getPtsdCutOff();
+	Dbls &ptsdx_ = ptsdx[treatment];
+	const std::vector<int> &active = schedule->active;
+
+	for(size_t k = 0; k < active.size(); ++k)
+	{
+		int id = active[k];
+
+		double strength = 0;
+		int max_sessions = -1;
+
+		if(curCBT[treatment][id] && !curSPR[treatment][id])
+		{
+			strength = param->cbt_coeff;
+			max_sessions = param->max_cbt_sessions;
+
+			sessionsCBT[treatment][id] += 1;
+			curCBT[treatment][id] = false;
+
+			counter->addCbtCount(this, id, tick, treatment);
+		}
+		else if(!curCBT[treatment][id] && curSPR[treatment][id])
+		{
+			strength = param->spr_coeff;
+			max_sessions = param->max_spr_sessions;
+
+			sessionsSPR[treatment][id] += 1;
+			curSPR[treatment][id] = false;
+
+			counter->addSprCount(this, id, tick, treatment);
+		}
+		else if(!curCBT[treatment][id] && !curSPR[treatment][id] && ptsdx_[id] > 0)
+		{
+			double randomP = random->uniform_real_dist();
+
+			max_sessions = param->nd_dur;
+			if(randomP < param->percent_nd)
+			{
+				if(ptsdx_[id] >= cutoff && treatment == STEPPED_CARE)
+					counter->addNaturalDecayCount(tick);
+				strength = param->nd_coeff;
+			}
+		}
+
+		if(ptsdx_[id] > 0)
+		{
+			ptsdx_[id] = ptsdx_[id] - (strength/max_sessions)*ptsdx_[id];
+
+			if(ptsdx_[id] < 0)
+				ptsdx_[id] = 0;
+
+			if(initPtsdx[id] >= cutoff)
+			{
+				if(ptsdx_[id] >= cutoff)
+				{
+					ptsdTime[treatment][id] += 1;
+					isResolved[treatment][id] = false;
+
+					counter->addPtsdCount(treatment, getPtsdType(id), tick);
+
+					//counter to keep track of time-spent by an agent at different levels of PTSDx
+					if(ptsdx_[id] <= MILD_PTSDX_MAX)
+						durMild[treatment][id]++;
+					else if(ptsdx_[id] <= MOD_PTSDX_MAX)
+						durMod[treatment][id]++;
+					else if(ptsdx_[id] <= MAX_PTSDX)
+						durSevere[treatment][id]++;
+				}
+				else if(ptsdx_[id] < cutoff && !isResolved[treatment][id])
+				{
+					isResolved[treatment][id] = true;
+
+					//relapse timer counts ticks resolved: due after time_relapse more ticks resolved
+					if(initPtsdx[id] > param->ptsdx_relapse && relapseTimer[treatment][id] <= param->time_relapse)
+						schedule->push(EVENT_RELAPSE+treatment, tick+param->time_relapse-relapseTimer[treatment][id], id);
+				}
+
+				if(isResolved[treatment][id])
+				{
+					counter->addPtsdResolvedCount(treatment, getPtsdType(id), tick);
+					resolvedTime[treatment][id] += 1;
+				}
+			}
+		}
+
+		if(isResolved[treatment][id] && initPtsdx[id] > param->ptsdx_relapse)
+			relapseTimer[treatment][id] += 1;
+	}
+}
+
+void PtsdState::symptomRelapse(int tick, int treatment, PtsdSchedule *schedule, Random *random)
+{
+	std::vector<int> &relapsing = schedule->relapsing[treatment];
+
+	//relapse events of agents still resolved since their event was scheduled
+	const std::vector<int> *events = schedule->getEvents(EVENT_RELAPSE+treatment, tick);
+	if(events != NULL)
+	{
+		for(auto id = events->begin(); id != events->end(); ++id)
+		{
+			if(isResolved[treatment][*id] && relapseTimer[treatment][*id] == param->time_relapse+1)
+				relapsing.push_back(*id);
+		}
+	}
+
+	size_t num = 0;
+	for(size_t k = 0; k < relapsing.size(); ++k)
+	{
+		int id = relapsing[k];
+		if(isResolved[treatment][id] && numRelapse[treatment][id] < param->num_relapse)
+		{
+			double randomP = random->uniform_real_dist();
+			if(randomP < param->percent_relapse)
+			{
+				ptsdx[treatment][id] = 0.8*initPtsdx[id];
+
+				curCBT[treatment][id] = false;
+				curSPR[treatment][id] = false;
+
+				isResolved[treatment][id] = false;
+				resolvedTime[treatment][id] = 0;
+
+				numRelapse[treatment][id] += 1;
+			}
+		}
+
+		if(numRelapse[treatment][id] < param->num_relapse)
+			relapsing[num++] = id;
+	}
+	relapsing.resize(num);
+}
+
+/**
+*	@brief Returns true if an agent can still change state: symptoms in a
+*	treatment arm, or a relapse that can still restore them
+*	@param id is agent ID
+*	@return true if agent is active
+*/
+bool PtsdState::isActive(int id) const
+{
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		if(ptsdx[i][id] > 0)
+			return true;
+		if(isResolved[i][id] && initPtsdx[id] > param->ptsdx_relapse && numRelapse[i][id] < param->num_relapse)
+			return true;
+	}
+	return false;
+}
+
+/**
+*	@brief Returns first tick at which no treatment can start: CBT and SPR end at
+*	treatment_time; non-cases are referred from CBT to SPR at the end of their CBT
+*	@return tick
+*/
+int PtsdState::getTreatmentEnd() const
+{
+	return std::max(param->treatment_time, param->screening_time+param->cbt_dur_non_cases+1);
+}
+
+void PtsdState::provideCBT(int id, int tick, int treatment, Random *random, Counter *counter)
+{
+	double pCBT = getTrtmentUptakeProbability(id, treatment, CBT);
+	if(pCBT > 0.0)
+	{
+		double randomP = random->uniform_real_dist();
+
+		if(randomP < pCBT && tick < getMaxCbtTime(id))
+		{
+			curSPR[treatment][id] = false;
+			if(sessionsCBT[treatment][id] < 2*param->max_cbt_sessions)
+				curCBT[treatment][id] = true;
+			else
+				curCBT[treatment][id] = false;
+
+			if(treatment == STEPPED_CARE)
+			{
+				if(sessionsCBT[treatment][id] == 0 && sessionsSPR[treatment][id] == 0 && ptsdx[treatment][id] >= getPtsdCutOff())
+					counter->addCbtReach(treatment, tick);
+			}
+		}
+		else
+		{
+			if(initPtsdx[id] < getPtsdCutOff() && tick == getMaxCbtTime(id))
+			{
+				cbtReferred[id] = false;
+				sprReferred[id] = true;
+			}
+			provideSPR(id, tick, treatment, random, counter);
+		}
+	}
+	else
+	{
+		curCBT[treatment][id] = false;
+	}
+}
+
+void PtsdState::provideSPR(int id, int tick, int treatment, Random *random, Counter *counter)
+{
+	curCBT[treatment][id] = false;
+
+	double pSPR = getTrtmentUptakeProbability(id, treatment, SPR);
+	if(pSPR > 0)
+	{
+		double randomP = random->uniform_real_dist();
+
+		if(randomP < pSPR && tick < param->treatment_time)
+		{
+			if(sessionsSPR[treatment][id] < param->max_spr_sessions)
+				curSPR[treatment][id] = true;
+			else
+				curSPR[treatment][id] = false;
+
+			if(sessionsCBT[treatment][id] == 0 && sessionsSPR[treatment][id] == 0 && ptsdx[treatment][id] >= getPtsdCutOff())
+				counter->addSprReach(treatment, tick);
+		}
+		else
+		{
+			curSPR[treatment][id] = false;
+		}
+	}
+	else
+	{
+		curSPR[treatment][id] = false;
+	}
+}
+
+double PtsdState::getTrtmentUptakeProbability(int id, int treatment, int type) const
+{
+	double cutoff = getPtsdCutOff();
+
+	int ptsd_case;
+	if(initPtsdx[id] >= cutoff && ptsdx[treatment][id] >= cutoff)
+		ptsd_case = PTSD_CASE;
+	else if(initPtsdx[id] < cutoff && ptsdx[treatment][id] != 0)
+		ptsd_case = PTSD_NON_CASE;
+	else
+		return 0.0;
+
+	int prior = (type == CBT) ? priorCBT[id] : priorSPR[id];
+	return uptakeProb[UPTAKE_REFERRED][ptsd_case][type][prior][covariates[id]];
+}
+
+int PtsdState::getMaxCbtTime(int id) const
+{
+	if(initPtsdx[id] >= getPtsdCutOff())
+		return param->treatment_time;
+	else
+		return param->screening_time+param->cbt_dur_non_cases;
+}
+
+size_t PtsdState::size() const
+{
+	return initPtsdx.size();
+}
+
+/**
+*	@brief Returns bytes of state per agent: covariate code and all per-agent and
+*	per-treatment-arm arrays
+*	@return bytes per agent
+*/
+size_t PtsdState::getBytesPerAgent() const
+{
+	size_t agent = sizeof(double) + 6*sizeof(uint8_t);
+	size_t arm = sizeof(double) + 9*sizeof(int16_t) + 3*sizeof(uint8_t);
+
+	return agent + NUM_TREATMENT*arm;
+}
+
+double PtsdState::getPtsdCutOff() const
+{
+	return param->ptsd_cutoff;
+}
+
+double PtsdState::getInitPTSDx(int id) const
+{
+	return initPtsdx[id];
+}
+
+double PtsdState::getPTSDx(int id, int treatment) const
+{
+	switch(treatment)
+	{
+	case STEPPED_CARE:
+	case USUAL_CARE:
+		return ptsdx[treatment][id];
+	default:
+		return -1;
+	}
+}
+
+bool PtsdState::getPTSDstatus(int id, int type) const
+{
+	return (ptsdStatus[id] >> type) & 1;
+}
+
+int PtsdState::getPtsdType(int id) const
+{
+	int ptsd_type = -1;
+
+	if(getPTSDstatus(id, PRIMARY))
+		ptsd_type = PRIMARY;
+	else if(getPTSDstatus(id, SECONDARY))
+		ptsd_type = SECONDARY;
+	else if(getPTSDstatus(id, TERTIARY))
+		ptsd_type = TERTIARY;
+
+	return ptsd_type;
+}
+
+bool PtsdState::getCBTReferred(int id) const
+{
+	return cbtReferred[id];
+}
+
+bool PtsdState::getSPRReferred(int id) const
+{
+	return sprReferred[id];
+}
+
+int PtsdState::getDurationMild(int id, int treatment) const
+{
+	return durMild[treatment][id];
+}
+
+int PtsdState::getDurationModerate(int id, int treatment) const
+{
+	return durMod[treatment][id];
+}
+
+int PtsdState::getDurationSevere(int id, int treatment) const
+{
+	return durSevere[treatment][id];
+}
+
+int PtsdState::getResolvedTime(int id, int treatment) const
+{
+	return resolvedTime[treatment][id];
+}
@@ -0,0 +1,146 @@
+#ifndef __PtsdState_h__
+#define __PtsdState_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "ViolenceAgent.h"
+
+namespace MVS
+{
+	struct ViolenceParams;
+}
+
+//covariate codes of treatment uptake: sex (2) x origin (4) x age category (3)
+#define NUM_COVARIATE_CODES 24
+
+//timer events of the tick kernel (relapse: one event per treatment arm)
+#define EVENT_PRIOR_UPTAKE 0
+#define EVENT_SCREENING 1
+#define EVENT_RELAPSE 2
+#define NUM_EVENTS (EVENT_RELAPSE+NUM_TREATMENT)
+
+class Random;
+class Counter;
+
+/**
+*	@brief Agents of a block of the tick kernel that can change state (active
+*	set) and their timer events, bucketed by tick. Agents enter the active set
+*	with PTSD symptoms and leave it once they can no longer change state (see
+*	PtsdState::isActive()). Prior treatment and screening are scheduled for all
+*	active agents; a relapse event is scheduled when an agent's symptoms resolve,
+*	for the tick its relapse timer passes time_relapse. Agents past that time are
+*	kept in a relapse list per treatment arm.
+*/
+struct PtsdSchedule
+{
+	typedef std::vector<std::vector<int>> Buckets;
+
+	void push(int, int, int);
+	const std::vector<int> * getEvents(int, int) const;
+
+	std::vector<int> active;
+	Buckets events[NUM_EVENTS]; //agent IDs by event and tick
+	std::vector<int> relapsing[NUM_TREATMENT];
+};
+
+/**
+*	@brief PTSD and treatment state of the agents of the Mass Violence model as a
+*	structure of arrays: one contiguous array per field, indexed by agent ID. The
+*	tick kernel (runTick()) applies the rules of a tick to a list of agents rule by
+*	rule, so that each loop touches only the arrays of its rule. Covariates of
+*	treatment uptake are packed into a code once per agent by addAgent() and are
+*	read-only afterwards; demographic fields stay in ViolenceAgent.
+*	Uptake probabilities of all covariate codes, prior treatments and PTSD case
+*	states are tabulated once from the uptake models of the parameters, so that
+*	the kernel looks them up instead of evaluating the logistic models.
+*	The kernel runs on the active set and timer events of a PtsdSchedule, so a
+*	tick touches only the agents that can change state.
+*/
+class PtsdState
+{
+public:
+	typedef std::vector<double> Dbls;
+	typedef std::vector<int16_t> Shorts;
+	typedef std::vector<uint8_t> Flags;
+	typedef std::pair<double, double> PairDD;
+
+	PtsdState();
+	virtual ~PtsdState();
+
+	void setParameters(const MVS::ViolenceParams *);
+	void addAgent(int, int, int, int);
+	void clear();
+
+	void reset(int, double);
+	void setPtsdStatus(int, int);
+	void setSymptoms(int, const PairDD &, Random *);
+
+	void schedule(PtsdSchedule *, const int *, size_t, int) const;
+	void runTick(int, PtsdSchedule *, Random *, Counter *);
+
+	size_t size() const;
+	size_t getBytesPerAgent() const;
+
+	double getPtsdCutOff() const;
+	double getInitPTSDx(int) const;
+	double getPTSDx(int, int) const;
+	bool getPTSDstatus(int, int) const;
+	int getPtsdType(int) const;
+	bool getCBTReferred(int) const;
+	bool getSPRReferred(int) const;
+	int getDurationMild(int, int) const;
+	int getDurationModerate(int, int) const;
+	int getDurationSevere(int, int) const;
+	int getResolvedTime(int, int) const;
+
+private:
+
+	void priorTreatmentUptake(const int *, size_t, Random *);
+	void ptsdScreeningSteppedCare(const int *, size_t, Random *, Counter *);
+	void provideTreatment(int, int, const int *, size_t, Random *, Counter *);
+	void symptomResolution(int, int, PtsdSchedule *, Random *, Counter *);
+	void symptomRelapse(int, int, PtsdSchedule *, Random *);
+
+	bool isActive(int) const;
+	int getTreatmentEnd() const;
+
+	void provideCBT(int, int, int, Random *, Counter *);
+	void provideSPR(int, int, int, Random *, Counter *);
+	double getTrtmentUptakeProbability(int, int, int) const;
+	int getMaxCbtTime(int) const;
+
+	void createUptakeTable();
+	static int getCovariateCode(int, int, int);
+
+	const MVS::ViolenceParams *param;
+
+	//[UPTAKE_PRIOR or UPTAKE_REFERRED][PTSD non-case or case][CBT or SPR][prior treatment][covariate code]
+	double uptakeProb[2][NUM_CASES][2][2][NUM_COVARIATE_CODES];
+
+	//covariate code of treatment uptake (read-only)
+	Flags covariates;
+
+	//ptsd variables
+	Dbls initPtsdx, ptsdx[NUM_TREATMENT];
+	Flags ptsdStatus; //bit per PTSD type (PRIMARY, SECONDARY, TERTIARY)
+	Shorts ptsdTime[NUM_TREATMENT];
+	Shorts durMild[NUM_TREATMENT], durMod[NUM_TREATMENT], durSevere[NUM_TREATMENT];
+
+	//treatment variables
+	Flags priorCBT, priorSPR;
+	Flags cbtReferred, sprReferred;
+	Flags curCBT[NUM_TREATMENT], curSPR[NUM_TREATMENT];
+	Shorts sessionsCBT[NUM_TREATMENT], sessionsSPR[NUM_TREATMENT];
+
+	//relapse variables
+	Shorts numRelapse[NUM_TREATMENT], relapseTimer[NUM_TREATMENT];
+
+	//resolution variables
+	Flags isResolved[NUM_TREATMENT];
+	Shorts resolvedTime[NUM_TREATMENT];
+};
+
+#endif __PtsdState_h__
@@ -1,49 +1,354 @@
 #include "Random.h"
 
-Random::Random() : rng((uint32_t)time(NULL))
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+
+//Poisson means from which transformed rejection replaces inversion
+#define POISSON_PTRS_MEAN 30
+
+#define TWO_PI 6.283185307179586
+
+/**
+*	@brief Stream of seed 0, MSA "", trial 0 and phase 0 (only for default 
+*	construction; use derived streams for draws)
+*/
+Random::Random() : bufPos(0), bufEnd(0), hasSpare(false), spare(0)
 {
+	key[0] = key[1] = 0;
+	ctr[0] = ctr[1] = ctr[2] = ctr[3] = 0;
+}
+
+/**
+*	@param seed is run seed ("--seed")
+*	@param metro is geoID of MSA
+*	@param trial is trial (or replicate) number
+*	@param phase is phase of the run (RNG_PHASE_...)
+*	@param block is block of agents or PUMAs drawn by one task
+*/
+Random::Random(uint32_t seed, const std::string &metro, uint32_t trial, uint32_t phase, uint32_t block) : 
+	bufPos(0), bufEnd(0), hasSpare(false), spare(0)
+{
+	key[0] = seed;
+	key[1] = hashMetro(metro);
+
+	ctr[0] = 0;
+	ctr[1] = block;
+	ctr[2] = trial;
+	ctr[3] = phase;
 }
 
 Random::~Random()
 {
 }
 
-double Random::uniform_real_dist()
+/**
+*	@brief Derives the stream of another phase and block of the same run, MSA and
+*	trial
+*	@param phase is phase of the run (RNG_PHASE_...)
+*	@param block is block of agents or PUMAs
+*	@return new stream at its start
+*/
+Random Random::split(uint32_t phase, uint32_t block) const
 {
-	boost::random::uniform_real_distribution<>dist(0, 1);
-	boost::random::variate_generator<boost::mt19937&, boost::random::uniform_real_distribution<>>generator(rng, dist);
+	Random stream;
+	stream.key[0] = key[0];
+	stream.key[1] = key[1];
 
-	return generator();
+	stream.ctr[1] = block;
+	stream.ctr[2] = ctr[2];
+	stream.ctr[3] = phase;
+	return stream;
 }
 
-double Random::uniform_real_dist(double min, double max)
+double Random::uniform_real_dist()
 {
-	boost::random::uniform_real_distribution<>dist(min, max);
-	boost::random::variate_generator<boost::mt19937&, boost::random::uniform_real_distribution<>>generator(rng, dist);
+	return toUnit(next64());
+}
 
-	return generator();
+double Random::uniform_real_dist(double min, double max)
+{
+	return min+(max-min)*uniform_real_dist();
 }
 
+/**
+*	@return uniform integer in [min, max] (unbiased by rejection)
+*/
 int Random::random_int(int min, int max)
 {
-	boost::random::uniform_int_distribution<>dist(min, max);
-	boost::random::variate_generator<boost::mt19937&, boost::random::uniform_int_distribution<>>generator(rng, dist);
+	uint64_t range = (uint64_t)((int64_t)max-min)+1;
+	uint64_t limit = UINT64_MAX-(UINT64_MAX%range);
+
+	uint64_t val;
+	do {
+		val = next64();
+	} while(val >= limit);
 
-	return generator();
+	return (int)((int64_t)min+(int64_t)(val%range));
 }
 
+/**
+*	@return normal variate (Box-Muller; the second variate of a pair is kept for
+*	the next call)
+*/
 double Random::normal_dist(double mean, double std_err)
 {
-	boost::random::normal_distribution<>dist(mean, std_err);
-	boost::random::variate_generator<boost::mt19937&, boost::random::normal_distribution<>>generator(rng, dist);
+	if(hasSpare)
+	{
+		hasSpare = false;
+		return mean+std_err*spare;
+	}
 
-	return generator();
+	double r = sqrt(-2*log(1-uniform_real_dist()));
+	double theta = TWO_PI*uniform_real_dist();
+
+	spare = r*sin(theta);
+	hasSpare = true;
+
+	return mean+std_err*r*cos(theta);
 }
 
+/**
+*	@return Poisson variate; inversion for small means and 
+*	transformed rejection (PTRS, Hormann 1993) for large means
+*/
 int Random::poisson_dist(double mean)
 {
-	boost::random::poisson_distribution<int>dist(mean);
-	boost::random::variate_generator<boost::mt19937&, boost::random::poisson_distribution<>>generator(rng, dist);
+	return poisson(getPoissonConsts(mean));
+}
+
+/**
+*	@brief Fills a buffer with uniform variates in [0, 1), converting whole runs
+*	of buffered words at a time
+*	@param values is output buffer
+*	@param num is number of variates
+*	@return void
+*/
+void Random::fill_uniform(double *values, size_t num)
+{
+	size_t i = 0;
+	while(i < num)
+	{
+		if(bufPos+2 > bufEnd)
+			refill();
+
+		size_t run = std::min(num-i, (bufEnd-bufPos)/2);
+		const uint32_t *words = &buffer[bufPos];
+		for(size_t j = 0; j < run; ++j)
+			values[i+j] = toUnit(((uint64_t)words[2*j] << 32) | words[2*j+1]);
+
+		i += run;
+		bufPos += 2*run;
+	}
+}
+
+/**
+*	@brief Fills a buffer with normal variates. Uniforms are generated in bulk into
+*	the output buffer and transformed in place pair by pair.
+*	@param values is output buffer
+*	@param num is number of variates
+*	@param mean is mean
+*	@param std_err is standard deviation
+*	@return void
+*/
+void Random::fill_normal(double *values, size_t num, double mean, double std_err)
+{
+	size_t i = 0;
+	if(hasSpare && num > 0)
+		values[i++] = normal_dist(mean, std_err);
+
+	size_t num_pairs = (num-i)/2;
+	double *pairs = values+i;
+	fill_uniform(pairs, 2*num_pairs);
+
+	for(size_t j = 0; j < num_pairs; ++j)
+	{
+		double r = sqrt(-2*log(1-pairs[2*j]));
+		double theta = TWO_PI*pairs[2*j+1];
+
+		pairs[2*j] = mean+std_err*r*cos(theta);
+		pairs[2*j+1] = mean+std_err*r*sin(theta);
+	}
+
+	i += 2*num_pairs;
+	if(i < num)
+		values[i] = normal_dist(mean, std_err);
+}
+
+/**
+*	@brief Fills a buffer with Poisson variates of one mean, computing the
+*	sampling constants of the mean once
+*	@param values is output buffer
+*	@param num is number of variates
+*	@param mean is mean
+*	@return void
+*/
+void Random::fill_poisson(int *values, size_t num, double mean)
+{
+	PoissonConsts consts = getPoissonConsts(mean);
+	for(size_t i = 0; i < num; ++i)
+		values[i] = poisson(consts);
+}
+
+/**
+*	@return state of the stream; equal states produce equal sequences
+*/
+std::string Random::getState() const
+{
+	//absolute position of the next word in the stream
+	uint64_t wordPos = (uint64_t)ctr[0]*4-(bufEnd-bufPos);
+
+	std::ostringstream state;
+	state.precision(17);
+	state << key[0] << " " << key[1] << " " << wordPos << " " << ctr[1] << " " << ctr[2] << " " << ctr[3]
+		<< " " << hasSpare << " " << spare;
+	return state.str();
+}
+
+void Random::setState(const std::string &state)
+{
+	uint64_t wordPos;
+
+	std::istringstream in(state);
+	in >> key[0] >> key[1] >> wordPos >> ctr[1] >> ctr[2] >> ctr[3] >> hasSpare >> spare;
+
+	ctr[0] = (uint32_t)(wordPos/4);
+	refill();
+	bufPos = (size_t)(wordPos%4);
+}
+
+/**
+*	@return 32-bit FNV-1a hash of MSA geoID (key of its streams)
+*/
+uint32_t Random::hashMetro(const std::string &metro)
+{
+	uint32_t hash = 2166136261U;
+	for(size_t i = 0; i < metro.size(); ++i)
+	{
+		hash ^= (unsigned char)metro[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+*	@brief Computes Philox4x32-10 of the next RNG_BUFFER_BLOCKS counters into the 
+*	buffer. Counters are kept as four word arrays and every round is applied to 
+*	all of them in one loop, so that the rounds are vectorized.
+*	@return void
+*/
+void Random::refill()
+{
+	uint32_t c0[RNG_BUFFER_BLOCKS], c1[RNG_BUFFER_BLOCKS], c2[RNG_BUFFER_BLOCKS], c3[RNG_BUFFER_BLOCKS];
+	for(int i = 0; i < RNG_BUFFER_BLOCKS; ++i)
+	{
+		c0[i] = ctr[0]+i;
+		c1[i] = ctr[1];
+		c2[i] = ctr[2];
+		c3[i] = ctr[3];
+	}
+
+	uint32_t k0 = key[0], k1 = key[1];
+	for(int r = 0; r < PHILOX_ROUNDS; ++r)
+	{
+		for(int i = 0; i < RNG_BUFFER_BLOCKS; ++i)
+		{
+			uint64_t p0 = (uint64_t)PHILOX_M0*c0[i];
+			uint64_t p1 = (uint64_t)PHILOX_M1*c2[i];
+
+			uint32_t x1 = c1[i], x3 = c3[i];
+			c0[i] = (uint32_t)(p1 >> 32)^x1^k0;
+			c1[i] = (uint32_t)p1;
+			c2[i] = (uint32_t)(p0 >> 32)^x3^k1;
+			c3[i] = (uint32_t)p0;
+		}
+
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+
+	for(int i = 0; i < RNG_BUFFER_BLOCKS; ++i)
+	{
+		buffer[4*i] = c0[i];
+		buffer[4*i+1] = c1[i];
+		buffer[4*i+2] = c2[i];
+		buffer[4*i+3] = c3[i];
+	}
+
+	ctr[0] += RNG_BUFFER_BLOCKS;
+	bufPos = 0;
+	bufEnd = 4*RNG_BUFFER_BLOCKS;
+}
+
+uint64_t Random::next64()
+{
+	if(bufPos+2 > bufEnd)
+		refill();
+
+	uint64_t val = ((uint64_t)buffer[bufPos] << 32) | buffer[bufPos+1];
+	bufPos += 2;
+	return val;
+}
+
+/**
+*	@return 53 random bits as double in [0, 1)
+*/
+double Random::toUnit(uint64_t val)
+{
+	return (val >> 11)*(1.0/9007199254740992.0);
+}
+
+Random::PoissonConsts Random::getPoissonConsts(double mean)
+{
+	PoissonConsts consts;
+	consts.mean = mean;
+	consts.limit = exp(-mean);
+
+	consts.slam = sqrt(mean);
+	consts.loglam = log(mean);
+	consts.b = 0.931+2.53*consts.slam;
+	consts.a = -0.059+0.02483*consts.b;
+	consts.invalpha = 1.1239+1.1328/(consts.b-3.4);
+	consts.vr = 0.9277-3.6224/(consts.b-2);
+	return consts;
+}
+
+int Random::poisson(const PoissonConsts &consts)
+{
+	if(consts.mean <= 0)
+		return 0;
+
+	if(consts.mean < POISSON_PTRS_MEAN)
+	{
+		//inversion by sequential search of the cumulative distribution
+		double u = uniform_real_dist();
+		double prob = consts.limit;
+		int k = 0;
+		while(u > prob && prob > 0)
+		{
+			u -= prob;
+			k++;
+			prob *= consts.mean/k;
+		}
+		return k;
+	}
+
+	while(true)
+	{
+		double u = uniform_real_dist()-0.5;
+		double v = uniform_real_dist();
+		double us = 0.5-fabs(u);
+		double k = floor((2*consts.a/us+consts.b)*u+consts.mean+0.43);
+
+		if(us >= 0.07 && v <= consts.vr)
+			return (int)k;
+
+		if(k < 0 || (us < 0.013 && v > us))
+			continue;
 
-	return generator();
+		if(log(v)+log(consts.invalpha)-log(consts.a/(us*us)+consts.b) <= -consts.mean+k*consts.loglam-lgamma(k+1))
+			return (int)k;
+	}
 }
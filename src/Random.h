@@ -1,20 +1,48 @@
 #ifndef __Random_h__
 #define __Random_h__
 
-#include <ctime>
-#include <boost/random/uniform_real_distribution.hpp>
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random.hpp>
-#include <boost/random/normal_distribution.hpp>
-#include <boost/random/poisson_distribution.hpp>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <algorithm>
 
+//phases of a run; each phase draws from its own stream
+#define RNG_PHASE_DRAW 0
+#define RNG_PHASE_RISK_FACTORS 1
+#define RNG_PHASE_POPULATION 2
+#define RNG_PHASE_SCHOOL 3
+#define RNG_PHASE_NETWORK 4
+#define RNG_PHASE_PTSD 5
+#define RNG_PHASE_TICKS 6
+
+//Philox blocks generated per refill of the stream buffer (4 words each)
+#define RNG_BUFFER_BLOCKS 64
+
+/**
+*	@brief Counter-based random number streams (Philox4x32-10). The output of a 
+*	stream is a pure function of its key (run seed, MSA) and a 128-bit counter 
+*	made of (position, block, trial, phase), so streams of different trials, 
+*	phases and blocks never overlap and do not depend on the order or the thread 
+*	in which they are used. A run with a given seed is therefore reproduced 
+*	bitwise at any thread count.
+*	Blocks are generated RNG_BUFFER_BLOCKS at a time into a buffer owned by the 
+*	stream, so scalar calls only pop words; the fill_* methods produce many 
+*	variates per call with distribution constants computed once. Buffering and
+*	bulk calls do not change the sequence: fill_uniform(n) returns the same 
+*	values as n calls of uniform_real_dist(). Streams are not shared between 
+*	threads; each task owns its stream (and its buffer).
+*/
 class Random
 {
 public:
 	Random();
+	Random(uint32_t, const std::string &, uint32_t, uint32_t, uint32_t block = 0);
 	virtual ~Random();
 
+	Random split(uint32_t, uint32_t) const;
+
 	double uniform_real_dist();
 	double uniform_real_dist(double, double);
 
@@ -23,7 +51,49 @@ public:
 	double normal_dist(double, double);
 	int poisson_dist(double);
 
+	void fill_uniform(double *, size_t);
+	void fill_normal(double *, size_t, double, double);
+	void fill_poisson(int *, size_t, double);
+
+	/**
+	*	@brief Fisher-Yates shuffle with this stream (replaces std::random_shuffle,
+	*	whose generator is global and implementation-defined)
+	*/
+	template <class It>
+	void shuffle(It first, It last)
+	{
+		for(int i = (int)(last-first)-1; i > 0; --i)
+			std::swap(first[i], first[random_int(0, i)]);
+	}
+
+	std::string getState() const;
+	void setState(const std::string &);
+
+	static uint32_t hashMetro(const std::string &);
+
 private:
-	boost::mt19937 rng;
+	//constants of Poisson sampling for a mean
+	struct PoissonConsts
+	{
+		double mean;
+		double limit; //exp(-mean), probability of 0 (inversion)
+		double slam, loglam, a, b, invalpha, vr; //transformed rejection
+	};
+
+	void refill();
+	uint64_t next64();
+
+	static double toUnit(uint64_t);
+	static PoissonConsts getPoissonConsts(double);
+	int poisson(const PoissonConsts &);
+
+	uint32_t key[2]; //run seed, MSA
+	uint32_t ctr[4]; //position of next block to generate, block, trial, phase
+
+	uint32_t buffer[4*RNG_BUFFER_BLOCKS];
+	size_t bufPos, bufEnd; //next word and end of generated words
+
+	bool hasSpare; //second normal variate of Box-Muller pair
+	double spare;
 };
-#endif
\ No newline at end of file
+#endif
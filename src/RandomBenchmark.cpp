@@ -0,0 +1,157 @@
+#include "RandomBenchmark.h"
+
+#define BENCHMARK_BUFFER_SIZE 4096
+
+/**
+*	@brief Runs all benchmark cases and prints time per variate, throughput and
+*	a checksum of generated values (keeps the work from being optimized away)
+*	@param seed is seed of generators
+*	@param num is number of variates per case
+*	@return void
+*/
+void RandomBenchmark::run(uint32_t seed, size_t num)
+{
+	std::cout << "Random variate generation (" << num << " variates per case):" << std::endl;
+	std::cout << "case, ns/variate, M variates/s, checksum" << std::endl;
+
+	double means[2] = {10, 40};
+
+	//former generator: one distribution and variate_generator per variate
+	report("mt19937 uniform", num, [&]()
+	{
+		boost::mt19937 rng(seed);
+		double sum = 0;
+		for(size_t i = 0; i < num; ++i)
+		{
+			boost::random::uniform_real_distribution<>dist(0, 1);
+			boost::random::variate_generator<boost::mt19937&, boost::random::uniform_real_distribution<>>generator(rng, dist);
+			sum += generator();
+		}
+		return sum;
+	});
+
+	report("mt19937 normal", num, [&]()
+	{
+		boost::mt19937 rng(seed);
+		double sum = 0;
+		for(size_t i = 0; i < num; ++i)
+		{
+			boost::random::normal_distribution<>dist(0, 1);
+			boost::random::variate_generator<boost::mt19937&, boost::random::normal_distribution<>>generator(rng, dist);
+			sum += generator();
+		}
+		return sum;
+	});
+
+	for(int m = 0; m < 2; ++m)
+	{
+		report("mt19937 poisson(" + std::to_string((int)means[m]) + ")", num, [&]()
+		{
+			boost::mt19937 rng(seed);
+			double sum = 0;
+			for(size_t i = 0; i < num; ++i)
+			{
+				boost::random::poisson_distribution<int>dist(means[m]);
+				boost::random::variate_generator<boost::mt19937&, boost::random::poisson_distribution<>>generator(rng, dist);
+				sum += generator();
+			}
+			return sum;
+		});
+	}
+
+	//scalar calls
+	report("Random uniform", num, [&]()
+	{
+		Random random(seed, "", 0, RNG_PHASE_DRAW);
+		double sum = 0;
+		for(size_t i = 0; i < num; ++i)
+			sum += random.uniform_real_dist();
+		return sum;
+	});
+
+	report("Random normal", num, [&]()
+	{
+		Random random(seed, "", 0, RNG_PHASE_DRAW);
+		double sum = 0;
+		for(size_t i = 0; i < num; ++i)
+			sum += random.normal_dist(0, 1);
+		return sum;
+	});
+
+	for(int m = 0; m < 2; ++m)
+	{
+		report("Random poisson(" + std::to_string((int)means[m]) + ")", num, [&]()
+		{
+			Random random(seed, "", 0, RNG_PHASE_DRAW);
+			double sum = 0;
+			for(size_t i = 0; i < num; ++i)
+				sum += random.poisson_dist(means[m]);
+			return sum;
+		});
+	}
+
+	//bulk fills
+	report("Random fill_uniform", num, [&]()
+	{
+		Random random(seed, "", 0, RNG_PHASE_DRAW);
+		std::vector<double> values(BENCHMARK_BUFFER_SIZE);
+		double sum = 0;
+		for(size_t i = 0; i < num; i += values.size())
+		{
+			size_t n = std::min(values.size(), num-i);
+			random.fill_uniform(values.data(), n);
+			for(size_t j = 0; j < n; ++j)
+				sum += values[j];
+		}
+		return sum;
+	});
+
+	report("Random fill_normal", num, [&]()
+	{
+		Random random(seed, "", 0, RNG_PHASE_DRAW);
+		std::vector<double> values(BENCHMARK_BUFFER_SIZE);
+		double sum = 0;
+		for(size_t i = 0; i < num; i += values.size())
+		{
+			size_t n = std::min(values.size(), num-i);
+			random.fill_normal(values.data(), n, 0, 1);
+			for(size_t j = 0; j < n; ++j)
+				sum += values[j];
+		}
+		return sum;
+	});
+
+	for(int m = 0; m < 2; ++m)
+	{
+		report("Random fill_poisson(" + std::to_string((int)means[m]) + ")", num, [&]()
+		{
+			Random random(seed, "", 0, RNG_PHASE_DRAW);
+			std::vector<int> values(BENCHMARK_BUFFER_SIZE);
+			double sum = 0;
+			for(size_t i = 0; i < num; i += values.size())
+			{
+				size_t n = std::min(values.size(), num-i);
+				random.fill_poisson(values.data(), n, means[m]);
+				for(size_t j = 0; j < n; ++j)
+					sum += values[j];
+			}
+			return sum;
+		});
+	}
+
+	std::cout << std::endl;
+}
+
+void RandomBenchmark::report(const std::string &name, size_t num, const Case &benchCase)
+{
+	TimePoint start = std::chrono::steady_clock::now();
+	double checksum = benchCase();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+
+	double ns = (num > 0) ? 1e6*ms/num : 0;
+	double rate = (ms > 0) ? num/(1000*ms) : 0;
+
+	std::cout << std::fixed << std::setprecision(2) << name << ", " << ns << ", " << rate << ", " 
+		<< std::setprecision(6) << checksum << std::endl;
+	std::cout.unsetf(std::ios::fixed);
+}
@@ -0,0 +1,36 @@
+#ifndef __RandomBenchmark_h__
+#define __RandomBenchmark_h__
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/poisson_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "Random.h"
+#include "ElapsedTime.h"
+
+/**
+*	@brief Microbenchmark of random variate generation. Compares the former 
+*	generator (Mersenne Twister with a distribution and variate_generator 
+*	constructed per variate), scalar calls of Random and bulk fills of Random
+*	for uniform, normal and Poisson variates.
+*/
+class RandomBenchmark
+{
+public:
+	static void run(uint32_t, size_t);
+
+private:
+	typedef std::function<double()> Case;
+
+	static void report(const std::string &, size_t, const Case &);
+};
+
+#endif __RandomBenchmark_h__
@@ -0,0 +1,137 @@
+#include "SocialGraph.h"
+
+SocialGraph::SocialGraph() : frozen(false), num_edges(0)
+{
+}
+
+SocialGraph::~SocialGraph()
+{
+}
+
+/**
+*	@brief Starts building a graph without edges
+*	@param num_agents is number of agents (IDs 0 to num_agents-1)
+*	@return void
+*/
+void SocialGraph::reset(size_t num_agents)
+{
+	clear();
+	degree.assign(num_agents, 0);
+	offsets.assign(num_agents+1, 0);
+}
+
+/**
+*	@brief Adds a friendship while the graph is built
+*	@param a is agent ID
+*	@param b is agent ID
+*	@return false if the edge is a self loop or already exists
+*/
+bool SocialGraph::addEdge(int a, int b)
+{
+	if(frozen || a == b || !edgeSet.insert(getEdgeKey(a, b)).second)
+		return false;
+
+	edgeBuffer.push_back(std::make_pair(a, b));
+	degree[a]++;
+	degree[b]++;
+	num_edges++;
+	return true;
+}
+
+/**
+*	@brief Converts the edge buffer into compressed sparse row form. Neighbors of
+*	an agent keep the order in which the edges were added.
+*	@return void
+*/
+void SocialGraph::freeze()
+{
+	if(frozen)
+		return;
+
+	size_t num_agents = degree.size();
+	for(size_t i = 0; i < num_agents; ++i)
+		offsets[i+1] = offsets[i]+degree[i];
+
+	neighbors.resize(2*edgeBuffer.size());
+	std::vector<size_t> next(offsets.begin(), offsets.end()-1);
+	for(auto edge = edgeBuffer.begin(); edge != edgeBuffer.end(); ++edge)
+	{
+		neighbors[next[edge->first]++] = edge->second;
+		neighbors[next[edge->second]++] = edge->first;
+	}
+
+	std::vector<std::pair<int, int>>().swap(edgeBuffer);
+	std::unordered_set<uint64_t>().swap(edgeSet);
+	std::vector<int>().swap(degree);
+	frozen = true;
+}
+
+void SocialGraph::clear()
+{
+	frozen = false;
+	num_edges = 0;
+
+	std::vector<std::pair<int, int>>().swap(edgeBuffer);
+	std::unordered_set<uint64_t>().swap(edgeSet);
+	std::vector<int>().swap(degree);
+	std::vector<size_t>().swap(offsets);
+	std::vector<int>().swap(neighbors);
+}
+
+bool SocialGraph::hasEdge(int a, int b) const
+{
+	if(!frozen)
+		return edgeSet.count(getEdgeKey(a, b)) > 0;
+
+	const int *friends = getFriends(a);
+	for(int i = 0; i < getDegree(a); ++i)
+	{
+		if(friends[i] == b)
+			return true;
+	}
+	return false;
+}
+
+int SocialGraph::getDegree(int a) const
+{
+	if(!frozen)
+		return degree[a];
+
+	return (int)(offsets[a+1]-offsets[a]);
+}
+
+/**
+*	@return IDs of friends of an agent (getDegree() of them); only valid once the
+*	graph is frozen
+*/
+const int * SocialGraph::getFriends(int a) const
+{
+	return neighbors.data()+offsets[a];
+}
+
+size_t SocialGraph::getNumAgents() const
+{
+	return (offsets.empty()) ? 0 : offsets.size()-1;
+}
+
+size_t SocialGraph::getNumEdges() const
+{
+	return num_edges;
+}
+
+/**
+*	@return bytes held by the graph (frozen graph: offsets and neighbor IDs)
+*/
+size_t SocialGraph::getMemoryBytes() const
+{
+	return offsets.capacity()*sizeof(size_t)+neighbors.capacity()*sizeof(int)+degree.capacity()*sizeof(int)
+		+edgeBuffer.capacity()*sizeof(std::pair<int, int>)+edgeSet.size()*(sizeof(uint64_t)+sizeof(void*));
+}
+
+uint64_t SocialGraph::getEdgeKey(int a, int b)
+{
+	if(a > b)
+		std::swap(a, b);
+
+	return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
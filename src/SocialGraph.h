@@ -0,0 +1,53 @@
+#ifndef __SocialGraph_h__
+#define __SocialGraph_h__
+
+#include <vector>
+#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+*	@brief Undirected friendship graph over dense integer agent IDs. While the 
+*	network is built, edges are appended to an edge buffer and duplicates are 
+*	rejected with a hashed edge set. freeze() converts the buffer into compressed 
+*	sparse row form (offsets and neighbor IDs) and releases the build structures;
+*	friends of an agent are then one contiguous run of IDs, in the order the 
+*	friendships were made.
+*/
+class SocialGraph
+{
+public:
+	SocialGraph();
+	virtual ~SocialGraph();
+
+	void reset(size_t);
+	bool addEdge(int, int);
+	void freeze();
+	void clear();
+
+	bool hasEdge(int, int) const;
+	int getDegree(int) const;
+	const int *getFriends(int) const;
+
+	size_t getNumAgents() const;
+	size_t getNumEdges() const;
+	size_t getMemoryBytes() const;
+
+private:
+	static uint64_t getEdgeKey(int, int);
+
+	bool frozen;
+	size_t num_edges;
+
+	//build structures
+	std::vector<std::pair<int, int>> edgeBuffer;
+	std::unordered_set<uint64_t> edgeSet;
+	std::vector<int> degree;
+
+	//compressed sparse row graph
+	std::vector<size_t> offsets;
+	std::vector<int> neighbors;
+};
+
+#endif __SocialGraph_h__
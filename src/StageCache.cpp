@@ -0,0 +1,212 @@
+#include "StageCache.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static const char *stageNames[NUM_CACHE_STAGES] = {"ipf", "refine", "ipu", "draw"};
+
+StageHash::StageHash() : hash(FNV_OFFSET)
+{
+}
+
+/**
+*	@param stage is name of the stage; the code version is always hashed
+*/
+StageHash::StageHash(const std::string &stage) : hash(FNV_OFFSET)
+{
+	add(std::string(STAGE_CACHE_VERSION));
+	add(stage);
+}
+
+void StageHash::add(const void *data, size_t num_bytes)
+{
+	const unsigned char *bytes = static_cast<const unsigned char*>(data);
+	for(size_t i = 0; i < num_bytes; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+}
+
+void StageHash::add(const std::string &str)
+{
+	//length prefix keeps ("ab","c") and ("a","bc") apart
+	add((uint64_t)str.size());
+	add(str.data(), str.size());
+}
+
+void StageHash::add(double val)
+{
+	add(&val, sizeof(val));
+}
+
+void StageHash::add(int val)
+{
+	add(&val, sizeof(val));
+}
+
+void StageHash::add(uint64_t val)
+{
+	add(&val, sizeof(val));
+}
+
+uint64_t StageHash::value() const
+{
+	return hash;
+}
+
+std::string StageHash::hex() const
+{
+	std::ostringstream str;
+	str << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return str.str();
+}
+
+void CacheWriter::putString(const std::string &str)
+{
+	put<uint64_t>(str.size());
+	buffer.append(str);
+}
+
+const std::string &CacheWriter::getData() const
+{
+	return buffer;
+}
+
+CacheReader::CacheReader() : pos(0), failed(false)
+{
+}
+
+std::string CacheReader::getString()
+{
+	uint64_t len = get<uint64_t>();
+	if(failed || pos+len > buffer.size())
+	{
+		failed = true;
+		return "";
+	}
+
+	std::string str = buffer.substr(pos, len);
+	pos += len;
+	return str;
+}
+
+void CacheReader::setData(const std::string &data)
+{
+	buffer = data;
+	pos = 0;
+	failed = false;
+}
+
+bool CacheReader::good() const
+{
+	return !failed;
+}
+
+/**
+*	@param cacheDir is cache directory (created if missing)
+*	@param metroID is geoID of the MSA
+*/
+StageCache::StageCache(const std::string &cacheDir, const std::string &metroID) : dir(cacheDir), geoID(metroID)
+{
+	for(int i = 0; i < NUM_CACHE_STAGES; ++i)
+		hits[i] = misses[i] = 0;
+
+#ifdef _WIN32
+	_mkdir(dir.c_str());
+#else
+	mkdir(dir.c_str(), 0755);
+#endif
+}
+
+StageCache::~StageCache()
+{
+}
+
+/**
+*	@brief Loads cached output of a stage
+*	@param stage is stage (STAGE_IPF, ...)
+*	@param key is hash of stage inputs
+*	@param reader receives the cached output
+*	@return true on a cache hit
+*/
+bool StageCache::load(int stage, const StageHash &key, CacheReader &reader)
+{
+	std::ifstream inFile(getFileName(stage, key), std::ios::in | std::ios::binary);
+
+	bool hit = false;
+	if(inFile.is_open())
+	{
+		std::ostringstream content;
+		content << inFile.rdbuf();
+		reader.setData(content.str());
+
+		//header guards against hash collisions of entries of other versions/stages
+		hit = (reader.getString() == STAGE_CACHE_VERSION && reader.get<uint64_t>() == key.value() && reader.good());
+	}
+
+	std::lock_guard<std::mutex> lock(statsLock);
+	if(hit)
+		hits[stage]++;
+	else
+		misses[stage]++;
+
+	return hit;
+}
+
+void StageCache::save(int stage, const StageHash &key, const CacheWriter &writer)
+{
+	CacheWriter header;
+	header.putString(STAGE_CACHE_VERSION);
+	header.put<uint64_t>(key.value());
+
+	std::string fileName = getFileName(stage, key);
+	std::ostringstream tmpName;
+	tmpName << fileName << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+
+	std::ofstream outFile(tmpName.str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!outFile.is_open())
+	{
+		std::cout << "Warning: Cannot write stage cache " << tmpName.str() << "!" << std::endl;
+		return;
+	}
+
+	outFile.write(header.getData().data(), header.getData().size());
+	outFile.write(writer.getData().data(), writer.getData().size());
+	outFile.close();
+
+	if(std::rename(tmpName.str().c_str(), fileName.c_str()) != 0)
+		std::remove(tmpName.str().c_str());
+}
+
+/**
+*	@return hits and misses of each stage, e.g. "ipf=hit refine=hit ipu=miss draw=2/3"
+*/
+std::string StageCache::getReport() const
+{
+	std::lock_guard<std::mutex> lock(statsLock);
+
+	std::ostringstream report;
+	for(int i = 0; i < NUM_CACHE_STAGES; ++i)
+	{
+		report << (i > 0 ? " " : "") << stageNames[i] << "=";
+		if(hits[i]+misses[i] == 0)
+			report << "-";
+		else if(hits[i]+misses[i] == 1)
+			report << (hits[i] > 0 ? "hit" : "miss");
+		else
+			report << hits[i] << "/" << hits[i]+misses[i];
+	}
+	return report.str();
+}
+
+std::string StageCache::getFileName(int stage, const StageHash &key) const
+{
+	return dir + geoID + "_" + stageNames[stage] + "_" + key.hex() + ".bin";
+}
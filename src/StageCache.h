@@ -0,0 +1,132 @@
+#ifndef __StageCache_h__
+#define __StageCache_h__
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+//version of cached stage outputs; bump when code of a cached stage changes
+#define STAGE_CACHE_VERSION "popbrewer-stage-cache-1"
+
+//cached stages of population synthesis
+#define STAGE_IPF 0
+#define STAGE_REFINE 1
+#define STAGE_IPU 2
+#define STAGE_DRAW 3
+#define NUM_CACHE_STAGES 4
+
+/**
+*	@brief 64-bit FNV-1a hash of stage inputs
+*/
+class StageHash
+{
+public:
+	StageHash();
+	StageHash(const std::string &);
+
+	void add(const void *, size_t);
+	void add(const std::string &);
+	void add(double);
+	void add(int);
+	void add(uint64_t);
+
+	uint64_t value() const;
+	std::string hex() const;
+
+private:
+	uint64_t hash;
+};
+
+/**
+*	@brief Serializes stage outputs into a byte buffer
+*/
+class CacheWriter
+{
+public:
+	template <class V>
+	void put(V val)
+	{
+		buffer.append(reinterpret_cast<const char*>(&val), sizeof(V));
+	}
+
+	void putString(const std::string &);
+	const std::string &getData() const;
+
+private:
+	std::string buffer;
+};
+
+/**
+*	@brief Reads stage outputs written by CacheWriter; reading past the end of 
+*	the buffer marks the reader as failed
+*/
+class CacheReader
+{
+public:
+	CacheReader();
+
+	template <class V>
+	V get()
+	{
+		V val = V();
+		if(pos+sizeof(V) > buffer.size())
+		{
+			failed = true;
+			return val;
+		}
+
+		memcpy(&val, buffer.data()+pos, sizeof(V));
+		pos += sizeof(V);
+		return val;
+	}
+
+	std::string getString();
+	void setData(const std::string &);
+	bool good() const;
+
+private:
+	std::string buffer;
+	size_t pos;
+	bool failed;
+};
+
+/**
+*	@brief Content-addressed store of stage outputs of an MSA. An output is saved
+*	as <dir>/<geoID>_<stage>_<key>.bin, where the key hashes the exact inputs of
+*	the stage and the keys of its upstream stages, so an output is reused only if
+*	nothing upstream has changed. Files are written to a temporary file and then
+*	renamed, so a crash never leaves a partial entry. Hits and misses are counted
+*	per stage.
+*/
+class StageCache
+{
+public:
+	StageCache(const std::string &, const std::string &);
+	virtual ~StageCache();
+
+	bool load(int, const StageHash &, CacheReader &);
+	void save(int, const StageHash &, const CacheWriter &);
+
+	std::string getReport() const;
+
+private:
+	std::string getFileName(int, const StageHash &) const;
+
+	std::string dir;
+	std::string geoID;
+
+	int hits[NUM_CACHE_STAGES];
+	int misses[NUM_CACHE_STAGES];
+	mutable std::mutex statsLock;
+};
+
+#endif __StageCache_h__
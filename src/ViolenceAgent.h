@@ -4,8 +4,6 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <map>
-#include <memory>
 #include "Agent.h"
 
 #define NUM_PTSD 3
@@ -34,108 +32,43 @@
 
 
 class PersonPums;
-class Parameters;
-class Random;
-class Counter;
+class AgentSet;
 
+/**
+*	@brief Agent of the Mass Violence model: demographics, school and friend size.
+*	Its PTSD and treatment state is kept by the model in PtsdState, indexed by
+*	the agent ID.
+*/
 class ViolenceAgent : public Agent
 {
 public:
-	typedef std::vector<ViolenceAgent*>FriendsPtr;
-	typedef std::pair<double, double> PairDD;
-	typedef std::map<std::string, PairDD> MapPair;
-	typedef std::map<std::string, double> MapDbl;
-	typedef std::map<std::string, bool> MapBool;
-
 	ViolenceAgent();
-	ViolenceAgent(std::shared_ptr<Parameters>, const PersonPums *, Random *rand, Counter *count, int, int);
+	ViolenceAgent(const PersonPums *, int, int);
 
 	virtual ~ViolenceAgent();
 
-	void excecuteRules(int);
-
-	void setAgentIdx(std::string);
 	void setAgeCat();
 	void setNewOrigin();
-	void setPTSDx(MapPair *, bool);
-	void setPTSDstatus(bool, int);
 	void setSchoolName(std::string);
 	void setFriendSize(int);
-	void setFriend(ViolenceAgent *);
-	void setDummyVariables();
-
-	std::string getAgentIdx() const;
-	double getInitPTSDx() const;
-	double getPTSDx(int) const;
-	double getPTSDx(PairDD) const;
-	double getPtsdCutOff() const;
-	bool getPTSDstatus(int) const;
-	bool getCBTReferred() const;
-	bool getSPRReferred() const;
-	short int getCBTsessions(int) const;
-	short int getSPRsessions(int) const;
-	int getPtsdType() const;
-	int getDurationMild(int) const;
-	int getDurationModerate(int) const;
-	int getDurationSevere(int) const;
-	int getResolvedTime(int) const;
+
+	int getAgentID() const;
+	short int getAgeCat() const;
+	short int getNewOrigin() const;
 
 	std::string getSchoolName() const;
-	FriendsPtr *getFriendList();
 	int getFriendSize() const;
-	int getTotalFriends() const;
-	int getMaxCbtTime() const;
-	int getMaxSprTime() const;
 
 	bool isStudent() const;
 	bool isTeacher() const;
-	bool isCompatible(const ViolenceAgent *) const;
-	bool isFriend(const ViolenceAgent *) const;
-	bool isPrimaryRisk(const MapBool *) const;
-	bool isSecondaryRisk(const MapBool *) const;
+	bool isPrimaryRisk(const AgentSet *) const;
+	bool isSecondaryRisk(const AgentSet *) const;
 
 private:
-	
-	void priorTreatmentUptake(int);
-	void ptsdScreeningSteppedCare(int);
-	void provideTreatment(int, int);
-	void symptomResolution(int, int);
-	void symptomRelapse(int);
-
-	void provideCBT(int, int);
-	void provideSPR(int, int);
-	double getTrtmentUptakeProbability(int, int);
-
-	Random *random;
-	Counter *counter;
-	std::shared_ptr<Parameters>parameters;
-
-	std::string schoolName, agentIdx;
+
+	std::string schoolName;
+	int agentID; //dense ID within the population of the model (see SocialGraph, PtsdState)
 	short int ageCat, newOrigin;
 	int friendSize;
-	FriendsPtr friendList;
-
-	//ptsd variables
-	double initPtsdx, ptsdx[NUM_TREATMENT];
-	bool priPTSD, secPTSD, terPTSD;
-	short int ptsdTime[NUM_TREATMENT];
-	short int durMild[NUM_TREATMENT], durMod[NUM_TREATMENT], durSevere[NUM_TREATMENT];
-
-	//treatment variables
-	short int priorCBT, priorSPR;
-	bool cbtReferred, sprReferred;
-	bool curCBT[NUM_TREATMENT], curSPR[NUM_TREATMENT];
-	short int sessionsCBT[NUM_TREATMENT], sessionsSPR[NUM_TREATMENT];
-	
-	//relapse variables
-	short int numRelapse[NUM_TREATMENT], relapseTimer[NUM_TREATMENT];
-
-	//resolution variables
-	bool isResolved[NUM_TREATMENT];
-	short int resolvedTime[NUM_TREATMENT];
-
-	//dummy variables
-	short int age1, age2, age3;
-	short int white, black, hispanic, other;
 };
-#endif
\ No newline at end of file
+#endif
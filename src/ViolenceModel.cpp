@@ -8,12 +8,19 @@
 #include "ACS.h"
 #include "Random.h"
 #include "ElapsedTime.h"
+#include "WorkStealingPool.h"
 
-ViolenceModel::ViolenceModel() : schoolName("Stoneman HS")
+ViolenceModel::ViolenceModel() : count(NULL), random(NULL), num_tick_threads(0), tick_order(TICK_MAJOR), schoolName("Stoneman HS"), num_agents(0)
 {
 	
 }
 
+ViolenceModel::ViolenceModel(std::shared_ptr<Parameters> param) : 
+	PopBrewer(param), count(NULL), random(NULL), num_tick_threads(0), tick_order(TICK_MAJOR), schoolName("Stoneman HS"), num_agents(0)
+{
+
+}
+
 ViolenceModel::~ViolenceModel()
 {
 	delete count;
@@ -22,29 +29,246 @@ ViolenceModel::~ViolenceModel()
 
 void ViolenceModel::start()
 {
-	if(parameters != NULL)
+	if(parameters == NULL)
 	{
-		count = new Counter(parameters);
-		random = new Random;
+		std::cout << "Error: Parameters are not initialized!" << std::endl;
+		exit(EXIT_SUCCESS);
 	}
-	else
+
+	run(getMetro());
+}
+
+/**
+*	@brief Runs the model trials on the population of an MSA
+*	@param metro is MSA
+*	@return void
+*/
+void ViolenceModel::run(Metro *metro)
+{
+	initialize(metro);
+
+	//replicate populations are written to file; the model is not run on them
+	if(parameters->getRunParam()->num_replicates > 1)
 	{
-		std::cout << "Error: Parameters are not initialized!" << std::endl;
+		metro->generateReplicates(parameters->getRunParam()->num_replicates);
+		metro->writeGofLog();
+		return;
+	}
+
+	runTrials(metro, parameters->getViolenceParam()->num_trials);
+	output();
+}
+
+/**
+*	@brief Checks run parameters and creates the counter and random stream of the
+*	model
+*	@param metro is MSA
+*	@return void
+*/
+void ViolenceModel::initialize(Metro *metro)
+{
+	count = new Counter(parameters);
+	random = new Random(parameters->getRunParam()->seed, metro->getGeoID(), 0, RNG_PHASE_POPULATION);
+	num_tick_threads = parameters->getRunParam()->num_threads;
+	tick_order = parameters->getRunParam()->tick_order;
+	ptsdState.setParameters(parameters->getViolenceParam());
+
+	//social network and school require individual agents
+	if(parameters->getRunParam()->pop_mode == POP_WEIGHTED)
+	{
+		std::cout << "Error: Weighted population mode is not supported by the Mass Violence model!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	if(parameters->getRunParam()->num_shards > 1)
+	{
+		std::cout << "Error: Sharding is not supported by the Mass Violence model (single MSA)!" << std::endl;
 		exit(EXIT_SUCCESS);
 	}
+}
+
+/**
+*	@brief Runs trials concurrently, each group of trials sharing a population on
+*	its own model (population, counter and random streams of the trials). Groups
+*	are the trials between redraws of the population ("--redraw-every", a group per
+*	trial by default). At most "--concurrent-trials" groups (default: one per 
+*	thread) hold a population at any time, and the threads are shared out among
+*	their ticks. Counters of the trials are reduced into the model counter, and fit
+*	records of their draws written to the fit log, in trial order, so outputs do 
+*	not depend on the number of concurrent trials.
+*	@param metro is MSA
+*	@param num_trials is number of trials
+*	@return void
+*/
+void ViolenceModel::runTrials(Metro *metro, int num_trials)
+{
+	//draws of all trials share the IPU solution
+	metro->solveIPU();
+
+	const RunParams *runParam = parameters->getRunParam();
+	int num_threads = runParam->num_threads;
+	if(num_threads == 0)
+		num_threads = std::max(1, (int)std::thread::hardware_concurrency());
 
-	int num_trials = parameters->getViolenceParam()->num_trials;
+	int group_size = (runParam->redraw_trials > 0) ? runParam->redraw_trials : std::max(1, num_trials);
+	int num_groups = (num_trials+group_size-1)/group_size;
+
+	int max_groups = (runParam->max_trials > 0) ? runParam->max_trials : num_threads;
+	max_groups = std::max(1, std::min(max_groups, num_groups));
+	int tick_threads = std::max(1, num_threads/max_groups);
+
+	std::vector<std::unique_ptr<Counter>> trialCounts(num_trials);
+
+	WorkStealingPool pool(max_groups, 0);
+	for(int g = 0; g < num_groups; ++g)
+	{
+		pool.submit([this, metro, g, group_size, num_trials, tick_threads, &trialCounts]()
+		{
+			ViolenceModel trialModel(parameters);
+			trialModel.initialize(metro);
+			trialModel.num_tick_threads = tick_threads;
+
+			int last = std::min(num_trials, (g+1)*group_size);
+			for(int i = g*group_size; i < last; ++i)
+			{
+				trialModel.runTrial(metro, i);
+				trialCounts[i].reset(new Counter(*trialModel.getCounter()));
+				trialModel.getCounter()->clearOutcomes();
+			}
+		}, 0);
+	}
+	pool.run();
+
+	metro->writeGofLog();
 	for(int i = 0; i < num_trials; ++i)
+		count->mergeTrial(*trialCounts[i]);
+}
+
+/**
+*	@brief Runs a trial: draws its population and runs the model on it. Between
+*	redraws ("--redraw-every") the population, school and network of the latest
+*	draw are restored instead.
+*	@param metro is MSA
+*	@param trial is trial number
+*	@return void
+*/
+void ViolenceModel::runTrial(Metro *metro, int trial)
+{
+	int redraw = parameters->getRunParam()->redraw_trials;
+	if(!snapshot.empty())
 	{
-		std::cout << "Simulation no: " << i+1 << std::endl;
+		if(redraw == 0 || trial % redraw != 0)
+		{
+			restoreTrial(metro, trial);
+			return;
+		}
+
+		clearList();
+	}
+
+	startTrial(metro, trial);
+
+	Random drawRandom = random->split(RNG_PHASE_DRAW, 0);
+	metro->createAgents(this, drawRandom, trial);
+
+	finishTrial(metro);
+}
 
-		createPopulation();
-		distributePtsdStatus();
-		runModel();
+/**
+*	@brief Prepares a trial before its households are drawn (by runTrial() or by
+*	a draw shared with other models)
+*	@param metro is MSA
+*	@param trial is trial number
+*	@return void
+*/
+void ViolenceModel::startTrial(Metro *metro, int trial)
+{
+	std::cout << "Simulation no: " << trial+1 << std::endl;
+
+	//agents hold a pointer to the model stream, which is switched per trial and phase
+	*random = Random(parameters->getRunParam()->seed, metro->getGeoID(), (uint32_t)trial, RNG_PHASE_POPULATION);
+	initializeHouseholdMap(PARKLAND);
+
+	std::cout << std::endl;
+	std::cout << "Creating Population for " << metro->getMetroName() << std::endl;
+}
 
+/**
+*	@brief Runs the model on the drawn population of a trial: creates the school,
+*	distributes PTSD, runs the ticks and releases the population. Fit of the draw
+*	is written to the fit log by the caller once its trials have run.
+*	@return void
+*/
+void ViolenceModel::finishTrial(Metro *)
+{
+	*random = random->split(RNG_PHASE_SCHOOL, 0);
+	createSchool(&pumaHouseholds[PARKLAND]);
+
+	if(parameters->getRunParam()->redraw_trials != 1)
+		takeSnapshot();
+
+	simulateTrial();
+
+	//population is kept for the trials restoring it
+	if(snapshot.empty())
 		clearList();
+}
+
+/**
+*	@brief Distributes PTSD and runs the ticks on the population of a trial. Random
+*	streams of both phases depend only on the trial, whether the population was 
+*	drawn or restored.
+*	@return void
+*/
+void ViolenceModel::simulateTrial()
+{
+	*random = random->split(RNG_PHASE_PTSD, 0);
+	distributePtsdStatus();
+
+	*random = random->split(RNG_PHASE_TICKS, 0);
+	runModel();
+}
+
+/**
+*	@brief Records the state of the agents once population, school and network are
+*	built. Agents then differ only in their PTSD symptoms; all other PTSD and 
+*	treatment variables are those of a new agent.
+*	@return void
+*/
+void ViolenceModel::takeSnapshot()
+{
+	snapshot.assign(agentsByID.size(), 0.0);
+	for(size_t id = 0; id < agentsByID.size(); ++id)
+	{
+		if(agentsByID[id] != NULL)
+			snapshot[id] = ptsdState.getInitPTSDx((int)id);
+	}
+}
+
+/**
+*	@brief Runs a trial on the population, school and network of the latest draw,
+*	with the agents restored to their snapshot
+*	@param metro is MSA
+*	@param trial is trial number
+*	@return void
+*/
+void ViolenceModel::restoreTrial(Metro *metro, int trial)
+{
+	std::cout << "Simulation no: " << trial+1 << " (population of " << metro->getMetroName() << " restored)" << std::endl;
+
+	*random = Random(parameters->getRunParam()->seed, metro->getGeoID(), (uint32_t)trial, RNG_PHASE_POPULATION);
+	for(size_t id = 0; id < agentsByID.size(); ++id)
+	{
+		if(agentsByID[id] != NULL)
+			ptsdState.reset((int)id, snapshot[id]);
 	}
 
+	count->initTrial();
+	simulateTrial();
+}
+
+void ViolenceModel::output()
+{
 	if(parameters->writeToFile())
 		count->output("miami");
 }
@@ -54,33 +278,28 @@ void ViolenceModel::addHousehold(const HouseholdPums *hh, int countHH)
 	if(pumaHouseholds.size() == 0)
 		exit(EXIT_SUCCESS);
 
+	//households are screened by ViolenceModel::Filter before they are handed over
 	int puma_code = hh->getPUMA();
-	std::vector<PersonPums> tempPersons;
-	int countPersons;
-
-	if(hh->getHouseholdType() >= ACS::HHType::MarriedFam)
-	{
-		Household tempHH;
-		tempHH.reserve(hh->getHouseholdSize());
+	if(pumaHouseholds.count(puma_code) == 0)
+		return;
 
-		tempPersons = hh->getPersons();
-		countPersons = 0;
-		for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
-		{
-			ViolenceAgent *agent = new ViolenceAgent(parameters, &(*pp), random, count, countHH, countPersons);
-			
-			agent->setFriendSize(random->poisson_dist(getMeanFriendSize()));
-			agent->setPTSDx(parameters->getPtsdSymptoms(), false);
+	const std::vector<PersonPums> &tempPersons = hh->getPersonList();
 
-			tempHH.push_back(*agent);
+	Household tempHH;
+	tempHH.reserve(hh->getHouseholdSize());
 
-			countPersons++;
-			delete agent;
-		}
+	for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
+	{
+		ViolenceAgent agent(&(*pp), countHH, num_agents++);
+		ptsdState.addAgent(agent.getAgentID(), agent.getSex(), agent.getAgeCat(), agent.getNewOrigin());
+			
+		agent.setFriendSize(random->poisson_dist(getMeanFriendSize()));
+		setPtsdSymptoms(&agent, false);
 
-		if(pumaHouseholds.count(puma_code) > 0)
-			pumaHouseholds[puma_code].push_back(tempHH);
+		tempHH.push_back(agent);
 	}
+
+	pumaHouseholds[puma_code].push_back(tempHH);
 }
 
 void ViolenceModel::addAgent(const PersonPums *p)
@@ -88,63 +307,120 @@ void ViolenceModel::addAgent(const PersonPums *p)
 	//do nothing here
 }
 
-void ViolenceModel::createPopulation()
+void ViolenceModel::addAgent(const PersonPums *, int)
 {
-	//Metro *metro = &metroAreas.at("10180");
-	Metro *metro = &metroAreas.at("33100");
-	//countyMap = metro->getPumaCountyMap();
-	
-	initializeHouseholdMap(PARKLAND);
+	//do nothing here
+}
 
-	std::cout << std::endl;
-	std::cout << "Creating Population for " << metro->getMetroName() << std::endl;
-	metro->createAgents(this);
+/**
+*	@brief Returns MSA of the model, DEFAULT_MSA unless selected with "--msa"
+*	@return MSA
+*/
+Metro * ViolenceModel::getMetro()
+{
+	std::vector<Metro*> metros = getSelectedMetros(DEFAULT_MSA);
+	if(metros.size() != 1)
+	{
+		std::cout << "Error: Mass Violence model runs on a single MSA!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
 
-	createSchool(&pumaHouseholds[PARKLAND]);
+	return metros.front();
 }
 
 void ViolenceModel::distributePtsdStatus()
 {
+	primaryRiskPool.resize(agentsByID.size());
+	secondaryRiskPool.resize(agentsByID.size());
+	tertiaryRiskPool.resize(agentsByID.size());
+
 	distPrimaryPtsd();
 	distSecondaryPtsd();
 	distTertiaryPtsd();
 }
 
+/**
+*	@brief Runs the ticks of the model. Agents are split into fixed blocks of
+*	TICK_BLOCK_AGENTS; each block has its own random stream, counter shard and
+*	schedule (active set and timer events) and blocks run concurrently on up to
+*	"--threads" threads (PtsdState::runTick()). Tick-major order runs all blocks
+*	through a tick before the next tick; agent-major order ("--tick-order=agent")
+*	runs each block through all ticks, keeping the block in cache, and shards keep
+*	the counts of all ticks. Either way shards are merged into the model counter
+*	tick by tick in block order, so results depend only on the seed and not on
+*	the number of threads or the order. Prevalence is over all agents of at least
+*	the minimum age, active or not.
+*	@return void
+*/
 void ViolenceModel::runModel()
 {
 	std::cout << std::endl;
 	std::cout << "Running mass violence model..." << std::endl;
+	std::cout << "Bytes per agent: " << sizeof(ViolenceAgent)+ptsdState.getBytesPerAgent() << " (agent: " << sizeof(ViolenceAgent)
+		<< ", PTSD state: " << ptsdState.getBytesPerAgent() << ")" << std::endl;
 	int curTick = 0;
-	int countPersons;
 	
 	VecDbls prevalence;
-	AgentListPtr tempAgents;
-	std::vector<Household>*households;
 	
 	for(auto map = pumaHouseholds.begin(); map != pumaHouseholds.end(); ++map)
 	{
-		households = &map->second;
-		//count->reset();
-		while(curTick < getMaxWeeks())
+		std::vector<int> agents;
+		for(auto hh = map->second.begin(); hh != map->second.end(); ++hh)
 		{
-			countPersons = 0;
-			for(auto hh = households->begin(); hh != households->end(); ++hh)
+			for(auto pp = hh->begin(); pp != hh->end(); ++pp)
 			{
-				for(auto pp = hh->begin(); pp != hh->end(); ++pp)
-				{
-					ViolenceAgent *agent = (&(*pp));
-					if(agent->getAge() < getMinAge())
-						continue;
+				if(pp->getAge() >= getMinAge())
+					agents.push_back(pp->getAgentID());
+			}
+		}
+
+		int countPersons = (int)agents.size();
+		size_t num_blocks = (agents.size()+TICK_BLOCK_AGENTS-1)/TICK_BLOCK_AGENTS;
+
+		std::vector<Random> blockRandom(num_blocks);
+		std::vector<Counter> shards(num_blocks, Counter(parameters));
+		std::vector<PtsdSchedule> schedules(num_blocks);
+		for(size_t b = 0; b < num_blocks; ++b)
+		{
+			size_t first = b*TICK_BLOCK_AGENTS;
+			size_t last = std::min(agents.size(), first+TICK_BLOCK_AGENTS);
+
+			blockRandom[b] = random->split(RNG_PHASE_TICKS, (uint32_t)b);
+			shards[b].initShard();
+			ptsdState.schedule(&schedules[b], &agents[first], last-first, getMaxWeeks());
+		}
 
-					agent->excecuteRules(curTick);
-					
-					if(curTick == getMaxWeeks()-1)
-						tempAgents.push_back(agent);
+		WorkStealingPool pool(num_tick_threads, 0);
+		if(tick_order == AGENT_MAJOR)
+		{
+			for(size_t b = 0; b < num_blocks; ++b)
+			{
+				pool.submit([this, &schedules, &blockRandom, &shards, b, curTick]()
+				{
+					for(int tick = curTick; tick < getMaxWeeks(); ++tick)
+						ptsdState.runTick(tick, &schedules[b], &blockRandom[b], &shards[b]);
+				}, 0);
+			}
+			pool.run();
+		}
 
-					countPersons++;
+		while(curTick < getMaxWeeks())
+		{
+			if(tick_order == TICK_MAJOR)
+			{
+				for(size_t b = 0; b < num_blocks; ++b)
+				{
+					pool.submit([this, &schedules, &blockRandom, &shards, b, curTick]()
+					{
+						ptsdState.runTick(curTick, &schedules[b], &blockRandom[b], &shards[b]);
+					}, 0);
 				}
+				pool.run();
 			}
 
+			for(size_t b = 0; b < num_blocks; ++b)
+				count->mergeTick(&shards[b], curTick);
+
 			prevalence = count->getPrevalence(curTick, countPersons);
 			count->computeOutcomes(curTick, countPersons);
 
@@ -157,7 +433,7 @@ void ViolenceModel::runModel()
 				<< "," << "ND: " << count->getNaturalDecayUptake(curTick-1) << std::endl;
 		}
 
-		count->computeCostEffectiveness(&tempAgents);
+		count->computeCostEffectiveness(&ptsdState, &agents);
 	}
 
 }
@@ -174,7 +450,7 @@ void ViolenceModel::createSchool(std::vector<Household>*households)
 	MapInt schoolDemoMap = parameters->getSchoolDemographics();
 	resizeHouseholds();
 	//std::vector<Household> *households(&pumaHouseholds[puma_area]);
-	std::random_shuffle(households->begin(), households->end());
+	random->shuffle(households->begin(), households->end());
 
 	std::string student_type;
 	int students_per_hh, num_teachers;
@@ -256,7 +532,7 @@ void ViolenceModel::createSchool(std::vector<Household>*households)
 			}
 			else
 			{
-				std::random_shuffle(hh->begin(), hh->end());
+				random->shuffle(hh->begin(), hh->end());
 				int count_teacher = 0;
 				for(auto pp = hh->begin(); pp != hh->end(); ++pp)
 				{
@@ -285,6 +561,8 @@ void ViolenceModel::createSchool(std::vector<Household>*households)
 	}
 
 	schoolDemographics();
+
+	*random = random->split(RNG_PHASE_NETWORK, 0);
 	createSocialNetwork(households, countPersons);
 }
 
@@ -314,7 +592,8 @@ void ViolenceModel::createAgentHashMap(AgentListMap *agentsMap, ViolenceAgent *a
 *	Matching is done based on age, race, gender and education of agents. Each agent is assigned a 
 *	predefined friends size from a poisson distribution with a mean friend size of 3.0. Social network
 *	is built for students, teachers and other agents. Students can have friends from same/different schools. 
-*	Teachers can have friends from school or other agents. 
+*	Teachers can have friends from school or other agents. Candidates are drawn from indexed pools
+*	(see FriendPool); agents leave the pools once they have reached their friend size.
 *	@param househoulds is vector containing list of households
 *	@param totalPersons is total number of agents who are 14 years or older
 *	@return void
@@ -329,6 +608,16 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 	count = 0;
 	waitTime = 2000; //milliseconds
 
+	TimePoint start = std::chrono::steady_clock::now();
+	size_t num_edges = 0;
+
+	indexAgents();
+	network.reset(agentsByID.size());
+
+	createFriendPool(&studentPool, &studentsMap, IN_SCHOOL_NETWORK);
+	createFriendPool(&teacherPool, &teachersMap, IN_SCHOOL_NETWORK);
+	createFriendPool(&otherPool, &othersMap, OUT_SCHOOL_NETWORK);
+
 	ElapsedTime timer;
 	for(auto hh = households->begin(); hh != households->end(); ++hh)
 	{
@@ -339,32 +628,36 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 				continue;
 
 			draws = 0;
-			while(a->getTotalFriends() < a->getFriendSize() && draws < getOuterDraws())
+			while(getTotalFriends(a) < a->getFriendSize() && draws < getOuterDraws())
 			{
 				draws++;
+				bool matched = false;
 				if(a->getSchoolName() == schoolName)
 				{
 					if(a->isStudent())
 					{
 						pSelection = random->uniform_real_dist();
 						if(pSelection > getPval(STUDENT))
-							findFriends(&studentsMap, a, IN_SCHOOL_NETWORK);
+							matched = findFriends(&studentPool, a, IN_SCHOOL_NETWORK);
 						else
-							findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+							matched = findFriends(&otherPool, a, OUT_SCHOOL_NETWORK);
 					}
 					else if(a->isTeacher())
 					{
 						pSelection = random->uniform_real_dist();
 						if(pSelection > getPval(TEACHER))
-							findFriends(&teachersMap, a, IN_SCHOOL_NETWORK);
+							matched = findFriends(&teacherPool, a, IN_SCHOOL_NETWORK);
 						else
-							findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+							matched = findFriends(&otherPool, a, OUT_SCHOOL_NETWORK);
 					}
 				}
 				else
 				{
-					findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+					matched = findFriends(&otherPool, a, OUT_SCHOOL_NETWORK);
 				}
+
+				if(matched)
+					num_edges++;
 			}
 
 			timer.stop();
@@ -378,28 +671,75 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 		}
 	}
 
+	network.freeze();
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
 	std::cout << "Social network building progress: " << 100*(double)count/totalPersons << "% completed!\n" << std::endl;
+	std::cout << "Friendships: " << num_edges << " in " << std::setprecision(4) << secs << "s (" 
+		<< ((secs > 0) ? num_edges/secs : 0) << " edges/sec)" << std::endl;
+	std::cout << "Social graph: " << network.getNumAgents() << " agents, " << network.getMemoryBytes() << " bytes" << std::endl;
 	
 	std::cout << "Total Pop (14 or older): " << totalPersons << std::endl;
 	std::cout << std::endl;
+
+	studentPool.clear();
+	teacherPool.clear();
+	otherPool.clear();
 	//networkAnalysis();
 }
 
+/**
+*	@brief Indexes agents of a network that still look for friends
+*	@param pool is index
+*	@param agentsMap is agents of the network
+*	@param network_type is in-school or out-of-school network
+*	@return void
+*/
+void ViolenceModel::createFriendPool(FriendPool *pool, AgentListMap *agentsMap, int network_type)
+{
+	pool->clear();
+	for(auto key = agentsMap->begin(); key != agentsMap->end(); ++key)
+	{
+		for(auto agent = key->second.begin(); agent != key->second.end(); ++agent)
+		{
+			ViolenceAgent *a = *agent;
+			if(getTotalFriends(a) < a->getFriendSize())
+				pool->insert(a, getPoolGroup(a->getOrigin(), a->getEducation(), network_type));
+		}
+	}
+}
 
-void ViolenceModel::findFriends(AgentListMap *agentsMap, ViolenceAgent *a, int network_type)
+/**
+*	@return matching group of origin (in-school network) or origin and education 
+*	(out-of-school network)
+*/
+int ViolenceModel::getPoolGroup(int origin, int edu, int network_type) const
 {
-	bool ageMatch, genderMatch;
-	double ageChoice, genderChoice;
-	int origin, edu;
-	std::string new_key, old_key;
+	if(network_type == IN_SCHOOL_NETWORK)
+		return origin;
 
-	new_key = old_key = "";
+	return origin*POOL_GROUP_EDU+edu;
+}
 
-	ViolenceAgent *b = NULL;
+/**
+*	@brief Looks for a friend of an agent. Each draw picks origin and education of
+*	the friend (ORIGIN and EDUCATION P values); candidates of that group are then 
+*	drawn uniformly and tested one by one with acceptFriend(), as many times as the
+*	group has candidates, before the next draw. Agents that cannot be friends of
+*	the agent (itself, its household and its friends) are redrawn without a test.
+*	Agents that reach their friend size leave all pools.
+*	@param pool is pool of candidates
+*	@param a is agent
+*	@param network_type is in-school or out-of-school network
+*	@return true if a friend was found
+*/
+bool ViolenceModel::findFriends(FriendPool *pool, ViolenceAgent *a, int network_type)
+{
+	std::vector<int> excluded = getExcludedFriends(a);
 
-	bool match_found = false;
+	int origin, edu, group;
 	int inner_draws = 0;
-	while(!match_found)
+	while(true)
 	{
 		inner_draws++;
 		if(inner_draws >= getInnerDraws())
@@ -410,62 +750,145 @@ void ViolenceModel::findFriends(AgentListMap *agentsMap, ViolenceAgent *a, int n
 
 		if(origin < 0 || edu < 0)
 			exit(EXIT_SUCCESS);
-		
-		if(network_type == IN_SCHOOL_NETWORK)
-			new_key = std::to_string(origin);
-		else if(network_type == OUT_SCHOOL_NETWORK)
-			new_key = std::to_string(origin)+std::to_string(edu);
 
-		if(old_key == new_key && !old_key.empty() && !new_key.empty())
-			break;
+		group = getPoolGroup(origin, edu, network_type);
 
-		if(agentsMap->count(new_key) > 0)
+		size_t num_candidates = pool->size(group);
+		for(auto id = excluded.begin(); id != excluded.end(); ++id)
 		{
-			std::random_shuffle(agentsMap->at(new_key).begin(), agentsMap->at(new_key).end());
-			for(size_t i = 0; i < agentsMap->at(new_key).size(); ++i)
-			{
-				b = agentsMap->at(new_key).at(i);
-				if(!(a->isCompatible(b)))
-					continue;
-			
-				ageMatch = genderMatch = true;
-				if(a->isStudent() || b->isStudent())
-				{
-					if(abs(a->getAge()-b->getAge()) > getAgeDiffStudents())
-						ageMatch = false;
-				}
-				else
-				{
-					ageChoice = random->uniform_real_dist();
-					if(ageChoice > getPval(AGE))
-					{
-						if(abs(a->getAge()-b->getAge()) > getAgeDiffOthers())
-							ageMatch = false;
-					}
-				}
+			if(pool->contains(*id, group))
+				num_candidates--;
+		}
 
-				genderChoice = random->uniform_real_dist();
-				if(genderChoice > getPval(GENDER))
-				{
-					if(a->getSex() != b->getSex())
-						genderMatch = false;
-				}
+		for(size_t i = 0; i < num_candidates;)
+		{
+			ViolenceAgent *b = pool->sample(group, random);
+			if(!isCompatible(a, b))
+				continue;
 
-				if(ageMatch && genderMatch)
-				{
-					a->setFriend(b);
-					b->setFriend(a);
+			++i;
+			if(!acceptFriend(a, b))
+				continue;
 
-					match_found = true;
-					break;
-				}
-			}
+			network.addEdge(a->getAgentID(), b->getAgentID());
+
+			releaseFriend(a);
+			releaseFriend(b);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+*	@brief Tests a candidate friend. The age difference is limited for students
+*	(either agent) and, unless waived with the AGE P value, for other agents; a
+*	friend of the other sex is accepted only if waived with the GENDER P value.
+*	@param a is agent
+*	@param b is candidate friend
+*	@return true if the candidate is accepted
+*/
+bool ViolenceModel::acceptFriend(const ViolenceAgent *a, const ViolenceAgent *b)
+{
+	if(a->isStudent() || b->isStudent())
+	{
+		if(abs(a->getAge()-b->getAge()) > getAgeDiffStudents())
+			return false;
+	}
+	else if(random->uniform_real_dist() > getPval(AGE))
+	{
+		if(abs(a->getAge()-b->getAge()) > getAgeDiffOthers())
+			return false;
+	}
+
+	if(random->uniform_real_dist() > getPval(GENDER))
+	{
+		if(a->getSex() != b->getSex())
+			return false;
+	}
+
+	return true;
+}
+
+/**
+*	@brief Lists agents that fail isCompatible() for an agent looking for a friend:
+*	itself, its household (agents of a household have consecutive IDs, see 
+*	addHousehold()) and its friends
+*	@param a is agent
+*	@return agent IDs
+*/
+std::vector<int> ViolenceModel::getExcludedFriends(const ViolenceAgent *a) const
+{
+	std::vector<int> excluded;
+	int id = a->getAgentID();
 
-			old_key = new_key;
+	int first = id;
+	while(first > 0 && agentsByID[first-1]->getHouseholdID() == a->getHouseholdID())
+		first--;
+
+	for(int hh = first; hh < (int)agentsByID.size() && agentsByID[hh]->getHouseholdID() == a->getHouseholdID(); ++hh)
+		excluded.push_back(hh);
+
+	const int *friends = network.getFriends(id);
+	for(int i = 0; i < getTotalFriends(a); ++i)
+		excluded.push_back(friends[i]);
+
+	return excluded;
+}
+
+/**
+*	@return true unless the agents are the same agent, share a household, are 
+*	already friends or b has reached its friend size
+*/
+bool ViolenceModel::isCompatible(const ViolenceAgent *a, const ViolenceAgent *b) const
+{
+	if(a->getHouseholdID() == b->getHouseholdID() || a->getAgentID() == b->getAgentID())
+		return false;
+
+	if(getTotalFriends(b) >= b->getFriendSize() || network.hasEdge(a->getAgentID(), b->getAgentID()))
+		return false;
+
+	return true;
+}
+
+int ViolenceModel::getTotalFriends(const ViolenceAgent *a) const
+{
+	return network.getDegree(a->getAgentID());
+}
+
+/**
+*	@brief Maps agent IDs to agents once the population is complete
+*	@return void
+*/
+void ViolenceModel::indexAgents()
+{
+	agentsByID.assign(num_agents, NULL);
+	for(auto map = pumaHouseholds.begin(); map != pumaHouseholds.end(); ++map)
+	{
+		for(auto hh = map->second.begin(); hh != map->second.end(); ++hh)
+		{
+			for(auto pp = hh->begin(); pp != hh->end(); ++pp)
+				agentsByID[pp->getAgentID()] = &(*pp);
 		}
 	}
 }
 
+/**
+*	@brief Removes an agent that has reached its friend size from the pools
+*	@param a is agent
+*	@return void
+*/
+void ViolenceModel::releaseFriend(const ViolenceAgent *a)
+{
+	if(getTotalFriends(a) < a->getFriendSize())
+		return;
+
+	studentPool.remove(a);
+	teacherPool.remove(a);
+	otherPool.remove(a);
+}
+
 
 /**
 *	@brief Draws directly affected agents (students and teachers) from list of students/teachers 
@@ -551,6 +974,14 @@ void ViolenceModel::distTertiaryPtsd()
 	std::cout << "Distribution complete!\n" << std::endl;
 }
 
+/**
+*	@brief Draws directly affected agents: an origin uniformly, then an agent of that 
+*	origin, so the draw stays on the origin buckets and the pool only tests membership
+*	@param agentsMap is students or teachers of the school by origin
+*	@param aff_agents receives drawn agents (teachers by sex)
+*	@param agent_type is STUDENT or TEACHER
+*	@return void
+*/
 void ViolenceModel::poolPrimaryRiskAgents(AgentListMap *agentsMap, AgentListMap *aff_agents, int agent_type)
 {
 	VecInts origins;
@@ -584,8 +1015,6 @@ void ViolenceModel::poolPrimaryRiskAgents(AgentListMap *agentsMap, AgentListMap
 		std::string rand_origin = std::to_string(origins[random->random_int(0, origins.size()-1)]);
 		if(agentsMap->count(rand_origin) > 0)
 		{
-			std::random_shuffle(agentsMap->at(rand_origin).begin(), agentsMap->at(rand_origin).end());
-
 			int size = agentsMap->at(rand_origin).size();
 			int idx = random->random_int(0, size-1);
 
@@ -606,89 +1035,80 @@ void ViolenceModel::poolPrimaryRiskAgents(AgentListMap *agentsMap, AgentListMap
 				aff_agents->insert(std::make_pair(key_gender, temp));
 			}
 			
-			primaryRiskPool.insert(std::make_pair(agent->getAgentIdx(), true));
+			primaryRiskPool.insert(agent->getAgentID());
 			affected_count--;
 		}
 	}
 }
 
+/**
+*	@brief Pools schoolmates in unaffected households, families in affected households
+*	and friends of directly affected agents, minus the primary pool combined word by
+*	word, and scans the pool for its agents
+*	@param aff_fam_friends receives pooled agents by sex
+*	@return void
+*/
 void ViolenceModel::poolSecondaryRiskAgents(AgentListMap *aff_fam_friends)
 {
-	std::string key_gender = "";
 	for(auto hh = schoolHouseholds.begin(); hh != schoolHouseholds.end(); ++hh)
 	{
 		Household *household = *hh; 
-		if(!isAffectedHousehold(household))
+		bool affected = isAffectedHousehold(household);
+		for(auto pp = household->begin(); pp != household->end(); ++pp)
 		{
-			for(auto pp = household->begin(); pp != household->end(); ++pp)
-			{
-				ViolenceAgent *agent = (&(*pp));
-				if(agent->getAge() < getMinAge())
-					continue;
+			ViolenceAgent *agent = (&(*pp));
+			if(agent->getAge() < getMinAge())
+				continue;
 
-				key_gender = std::to_string(agent->getSex());
-				if(!agent->isPrimaryRisk(&primaryRiskPool)  && !agent->isSecondaryRisk(&secondaryRiskPool))
-				{
-					if(agent->getSchoolName() == schoolName)
-					{
-						aff_fam_friends->at(key_gender).push_back(agent);
-						secondaryRiskPool.insert(std::make_pair(agent->getAgentIdx(), true));
-					}
-				}
+			if(!affected)
+			{
+				if(agent->getSchoolName() == schoolName)
+					secondaryRiskPool.insert(agent->getAgentID());
 			}
-		}
-		else
-		{
-			for(auto pp = household->begin(); pp != household->end(); ++pp)
+			else if(agent->isPrimaryRisk(&primaryRiskPool))
 			{
-				ViolenceAgent *agent = (&(*pp));
-				if(agent->getAge() < getMinAge())
-					continue;
-
-				if(agent->isPrimaryRisk(&primaryRiskPool))
-				{
-					AgentListPtr *friendList = agent->getFriendList();
-					for(auto ff = friendList->begin(); ff != friendList->end(); ++ff)
-					{
-						ViolenceAgent *frnd = *ff;
-						key_gender = std::to_string(frnd->getSex());
-						if(!frnd->isPrimaryRisk(&primaryRiskPool) && !frnd->isSecondaryRisk(&secondaryRiskPool))
-						{
-							aff_fam_friends->at(key_gender).push_back(frnd);
-							secondaryRiskPool.insert(std::make_pair(frnd->getAgentIdx(), true));
-						}
-					}
-				}
-				else
-				{
-					key_gender = std::to_string(agent->getSex());
-					if(!agent->isSecondaryRisk(&secondaryRiskPool))
-					{
-						aff_fam_friends->at(key_gender).push_back(agent);
-						secondaryRiskPool.insert(std::make_pair(agent->getAgentIdx(), true));
-					}
-				}
+				const int *friends = network.getFriends(agent->getAgentID());
+				for(int i = 0; i < getTotalFriends(agent); ++i)
+					secondaryRiskPool.insert(friends[i]);
+			}
+			else
+			{
+				secondaryRiskPool.insert(agent->getAgentID());
 			}
 		}
 	}
+
+	secondaryRiskPool.subtract(primaryRiskPool);
+
+	for(int id = secondaryRiskPool.next(0); id >= 0; id = secondaryRiskPool.next(id+1))
+	{
+		ViolenceAgent *a = agentsByID[id];
+		aff_fam_friends->at(std::to_string(a->getSex())).push_back(a);
+	}
 }
 
+/**
+*	@brief Pools community members (agents outside the school network) who are at
+*	neither primary nor secondary risk: the set of community members minus both
+*	pools, combined word by word and scanned for its agents
+*	@param community receives pooled agents by sex
+*	@return void
+*/
 void ViolenceModel::poolTertiaryRiskAgents(AgentListMap *community)
 {
-	std::string key_gender = "";
 	for(auto map = othersMap.begin(); map != othersMap.end(); ++map)
 	{
-		AgentListPtr agentList = map->second;
-		for(auto agent = agentList.begin(); agent != agentList.end(); ++agent)
-		{
-			ViolenceAgent *a = *agent;
-			key_gender = std::to_string(a->getSex());
-			if(!a->isPrimaryRisk(&primaryRiskPool) && !a->isSecondaryRisk(&secondaryRiskPool))
-			{
-				community->at(key_gender).push_back(a);
-				tertiaryRiskPool.insert(std::make_pair(a->getAgentIdx(), true));
-			}
-		}
+		for(auto agent = map->second.begin(); agent != map->second.end(); ++agent)
+			tertiaryRiskPool.insert((*agent)->getAgentID());
+	}
+
+	tertiaryRiskPool.subtract(primaryRiskPool);
+	tertiaryRiskPool.subtract(secondaryRiskPool);
+
+	for(int id = tertiaryRiskPool.next(0); id >= 0; id = tertiaryRiskPool.next(id+1))
+	{
+		ViolenceAgent *a = agentsByID[id];
+		community->at(std::to_string(a->getSex())).push_back(a);
 	}
 }
 
@@ -726,8 +1146,6 @@ void ViolenceModel::schoolDemographics()
 
 void ViolenceModel::networkAnalysis()
 {
-	typedef std::vector<ViolenceAgent *> FriendsPtr;
-
 	std::cout << std::endl;
 	std::cout << "Social Network Analysis: " << std::endl;
 	int count = 0;
@@ -738,14 +1156,14 @@ void ViolenceModel::networkAnalysis()
 		for(auto pp1 = hh->begin(); pp1 != hh->end(); ++pp1)
 		{
 			ViolenceAgent *agent1 = &(*pp1);
-			if(agent1->getTotalFriends() != agent1->getFriendSize())
-				std::cout << ++count << "," << agent1->getAgentIdx() << "," << agent1->getTotalFriends() << "," << agent1->getFriendSize() << std::endl;
+			if(getTotalFriends(agent1) != agent1->getFriendSize())
+				std::cout << ++count << "," << agent1->getAgentID() << "," << getTotalFriends(agent1) << "," << agent1->getFriendSize() << std::endl;
 
-			FriendsPtr *friends = agent1->getFriendList();
-			for(auto pp2 = friends->begin(); pp2 != friends->end(); ++pp2) 
+			const int *friends = network.getFriends(agent1->getAgentID());
+			for(int i = 0; i < getTotalFriends(agent1); ++i) 
 			{
-				ViolenceAgent *agent2 = *pp2;
-				if(agent1->getAgentIdx() == agent2->getAgentIdx())
+				ViolenceAgent *agent2 = agentsByID[friends[i]];
+				if(agent1->getAgentID() == agent2->getAgentID())
 				{
 					std::cout << "Error: Cannot have self as a friend!" << std::endl;
 					exit(EXIT_SUCCESS);
@@ -760,7 +1178,7 @@ void ViolenceModel::networkAnalysis()
 				if(agent1->isStudent())
 				{
 					if(abs(agent1->getAge()-agent2->getAge()) > getAgeDiffStudents())
-						std::cout << agent1->getAgentIdx() << std::endl;
+						std::cout << agent1->getAgentID() << std::endl;
 				}
 
 			}
@@ -1004,34 +1422,62 @@ void ViolenceModel::setSize(int pop)
 	//do nothing here
 }
 
+void ViolenceModel::flushPuma(int)
+{
+	//households outside the modelled PUMAs are never stored; nothing to release
+}
+
 void ViolenceModel::setPtsdStatus(AgentListMap *affectedAgents, int sex, double preval, int type)
 {
 	if(preval < 0)
 		exit(EXIT_SUCCESS);
 
-	//MapDbl *m_ptsdx = parameters->getPtsdSymptoms();
-	MapPair *m_ptsdx = parameters->getPtsdSymptoms();
-
 	std::string key_sex = std::to_string(sex);
 	size_t prev_count = boost::math::round(preval*affectedAgents->at(key_sex).size());
 	while(prev_count > 0)
 	{
-		std::random_shuffle(affectedAgents->at(key_sex).begin(), affectedAgents->at(key_sex).end());
+		random->shuffle(affectedAgents->at(key_sex).begin(), affectedAgents->at(key_sex).end());
 
 		int sample_size = affectedAgents->at(key_sex).size();
 		int randIdx = random->random_int(0, sample_size-1);
 
 		ViolenceAgent *affAgent = affectedAgents->at(key_sex).at(randIdx);
-		if(affAgent->getPTSDstatus(type))
+		if(ptsdState.getPTSDstatus(affAgent->getAgentID(), type))
 			continue;
 
-		affAgent->setPTSDstatus(true, type);
-		affAgent->setPTSDx(m_ptsdx, true);
+		ptsdState.setPtsdStatus(affAgent->getAgentID(), type);
+		setPtsdSymptoms(affAgent, true);
 
 		prev_count--;
 	}
 }
 
+/**
+*	@brief Draws PTSD symptoms of an agent (of age 14 or above) from the symptom 
+*	distribution of its sex, age category and PTSD status
+*	@param agent is agent
+*	@param isPtsd is PTSD status
+*	@return void
+*/
+void ViolenceModel::setPtsdSymptoms(const ViolenceAgent *agent, bool isPtsd)
+{
+	if(agent->getAge() < 14)
+		return;
+
+	MapPair *m_ptsdx = parameters->getPtsdSymptoms();
+
+	std::string ptsd_status = (isPtsd) ? "1" : "0";
+	std::string key_ptsd = std::to_string(agent->getSex())+std::to_string(agent->getAgeCat())+ptsd_status;
+
+	if(m_ptsdx->count(key_ptsd) == 0)
+	{
+		std::cout << "Error: Strata " << key_ptsd << " doesn't exist!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	ptsdState.setSymptoms(agent->getAgentID(), m_ptsdx->at(key_ptsd), random);
+}
+
 void ViolenceModel::clearList()
 {
 	for(auto it = pumaHouseholds.begin(); it != pumaHouseholds.end(); ++it)
@@ -1049,5 +1495,12 @@ void ViolenceModel::clearList()
 	primaryRiskPool.clear();
 	secondaryRiskPool.clear();
 	tertiaryRiskPool.clear();
+
+	network.clear();
+	agentsByID.clear();
+	num_agents = 0;
+
+	std::vector<double>().swap(snapshot);
+	ptsdState.clear();
 }
 
@@ -13,6 +13,11 @@
 
 #include "PopBrewer.h"
 #include "ViolenceAgent.h"
+#include "AgentFilter.h"
+#include "FriendPool.h"
+#include "SocialGraph.h"
+#include "AgentSet.h"
+#include "PtsdState.h"
 
 class Counter;
 class PersonPums;
@@ -21,12 +26,21 @@ class Metro;
 class County;
 class Random;
 
+//MSA of the modelled school (Miami-Fort Lauderdale-West Palm Beach)
+#define DEFAULT_MSA "33100"
+
 #define PARKLAND 1101
 #define TAYLOR 2700
 
 #define IN_SCHOOL_NETWORK 1
 #define OUT_SCHOOL_NETWORK 0
 
+//agents per block of tick execution (own random stream and counter shard)
+#define TICK_BLOCK_AGENTS 1024
+
+//multiplier of origin in friend pool groups of origin and education
+#define POOL_GROUP_EDU 100
+
 //identifiers of P values
 #define STUDENT 0
 #define TEACHER 1
@@ -60,13 +74,32 @@ public:
 	typedef std::pair<double, double> PairDD;
 	typedef std::map<std::string, PairDD> MapPair;
 
+	//Only family households are added to the mass violence population
+	struct Filter : public AcceptAll
+	{
+		static bool acceptHousehold(const HouseholdPums *hh)
+		{
+			return (hh->getHouseholdType() >= ACS::HHType::MarriedFam);
+		}
+	};
+
 	ViolenceModel();
+	ViolenceModel(std::shared_ptr<Parameters>);
 	virtual ~ViolenceModel();
 
 	void start();
+	void run(Metro *);
+
+	void initialize(Metro *);
+	void runTrials(Metro *, int);
+	void runTrial(Metro *, int);
+	void startTrial(Metro *, int);
+	void finishTrial(Metro *);
+	void output();
 
 	void addHousehold(const HouseholdPums *, int);
 	void addAgent(const PersonPums *);
+	void addAgent(const PersonPums *, int);
 
 	Counter * getCounter() const;
 	
@@ -88,21 +121,35 @@ public:
 	double getPrevalence(int) const;
 
 	void setSize(int);
+	void flushPuma(int);
 	void setPtsdStatus(AgentListMap *, int, double, int);
+	void setPtsdSymptoms(const ViolenceAgent *, bool);
 
 	void clearList();
 
 private:
 
-	void createPopulation();
+	Metro *getMetro();
 	void distributePtsdStatus();
 	void runModel();
+	void simulateTrial();
+
+	void takeSnapshot();
+	void restoreTrial(Metro *, int);
 
 	void createSchool(std::vector<Household>*);
 	void createAgentHashMap(AgentListMap *, ViolenceAgent *, int);
 
 	void createSocialNetwork(std::vector<Household>*, int);
-	void findFriends(AgentListMap *, ViolenceAgent *, int);
+	void createFriendPool(FriendPool *, AgentListMap *, int);
+	int getPoolGroup(int, int, int) const;
+	bool findFriends(FriendPool *, ViolenceAgent *, int);
+	bool isCompatible(const ViolenceAgent *, const ViolenceAgent *) const;
+	bool acceptFriend(const ViolenceAgent *, const ViolenceAgent *);
+	std::vector<int> getExcludedFriends(const ViolenceAgent *) const;
+	int getTotalFriends(const ViolenceAgent *) const;
+	void indexAgents();
+	void releaseFriend(const ViolenceAgent *);
 
 	void distPrimaryPtsd();
 	void distSecondaryPtsd();
@@ -121,6 +168,8 @@ private:
 	
 	Counter *count;
 	Random *random;
+	int num_tick_threads; //threads running the blocks of agents of a tick
+	int tick_order; //TICK_MAJOR or AGENT_MAJOR
 
 	std::string schoolName;
 
@@ -128,7 +177,17 @@ private:
 	HouseholdListPtr schoolHouseholds;
 	
 	AgentListMap studentsMap, teachersMap, othersMap;
-	MapBool primaryRiskPool, secondaryRiskPool, tertiaryRiskPool;
+	FriendPool studentPool, teacherPool, otherPool; //agents looking for friends, while the network is built
+	AgentSet primaryRiskPool, secondaryRiskPool, tertiaryRiskPool; //by agent ID
+
+	int num_agents; //agents created, next agent ID
+	AgentListPtr agentsByID;
+	SocialGraph network;
+	PtsdState ptsdState; //PTSD and treatment state by agent ID
+
+	//PTSD symptoms of agents (by ID) once population, school and network are built;
+	//restored by trials that reuse them (see "--redraw-every")
+	std::vector<double> snapshot;
 	
 	//std::multimap<int, County> countyMap;
 	//std::multimap<std::string, ViolenceAgent> m_students;
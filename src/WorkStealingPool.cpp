@@ -0,0 +1,126 @@
+#include "WorkStealingPool.h"
+
+/**
+*	@param workers is number of worker threads (0: number of hardware threads)
+*	@param budget is memory budget in bytes (0: unlimited)
+*/
+WorkStealingPool::WorkStealingPool(int workers, size_t budget) :
+	num_workers(workers), memBudget(budget), memInUse(0), num_running(0), num_submitted(0)
+{
+	if(num_workers <= 0)
+		num_workers = std::max(1, (int)std::thread::hardware_concurrency());
+
+	queues.resize(num_workers);
+	for(int i = 0; i < num_workers; ++i)
+		queueLocks.push_back(std::unique_ptr<std::mutex>(new std::mutex));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+}
+
+void WorkStealingPool::submit(const Task &task, size_t mem)
+{
+	Job job;
+	job.task = task;
+	job.mem = mem;
+
+	queues[num_submitted % num_workers].push_back(job);
+	num_submitted++;
+}
+
+/**
+*	@brief Runs all submitted tasks and returns once every task has completed
+*	@return void
+*/
+void WorkStealingPool::run()
+{
+	std::vector<std::thread> workers;
+	for(int i = 0; i < num_workers; ++i)
+		workers.push_back(std::thread(&WorkStealingPool::work, this, i));
+
+	for(auto t = workers.begin(); t != workers.end(); ++t)
+		t->join();
+
+	num_submitted = 0;
+}
+
+int WorkStealingPool::getNumWorkers() const
+{
+	return num_workers;
+}
+
+void WorkStealingPool::work(int id)
+{
+	Job job;
+	while(nextJob(id, job))
+	{
+		acquire(job.mem);
+		job.task();
+		release(job.mem);
+	}
+}
+
+bool WorkStealingPool::nextJob(int id, Job &job)
+{
+	{
+		std::lock_guard<std::mutex> lock(*queueLocks[id]);
+		if(!queues[id].empty())
+		{
+			job = queues[id].front();
+			queues[id].pop_front();
+			return true;
+		}
+	}
+
+	//steals from the worker with most remaining tasks
+	while(true)
+	{
+		int victim = -1;
+		size_t max_jobs = 0;
+		for(int i = 0; i < num_workers; ++i)
+		{
+			if(i == id)
+				continue;
+
+			std::lock_guard<std::mutex> lock(*queueLocks[i]);
+			if(queues[i].size() > max_jobs)
+			{
+				max_jobs = queues[i].size();
+				victim = i;
+			}
+		}
+
+		if(victim < 0)
+			return false;
+
+		std::lock_guard<std::mutex> lock(*queueLocks[victim]);
+		if(!queues[victim].empty())
+		{
+			job = queues[victim].front();
+			queues[victim].pop_front();
+			return true;
+		}
+	}
+}
+
+void WorkStealingPool::acquire(size_t mem)
+{
+	std::unique_lock<std::mutex> lock(memLock);
+	if(memBudget > 0)
+		memFreed.wait(lock, [&]{ return num_running == 0 || memInUse+mem <= memBudget; });
+
+	memInUse += mem;
+	num_running++;
+}
+
+void WorkStealingPool::release(size_t mem)
+{
+	{
+		std::lock_guard<std::mutex> lock(memLock);
+		memInUse -= mem;
+		num_running--;
+	}
+
+	memFreed.notify_all();
+}
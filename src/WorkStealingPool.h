@@ -0,0 +1,63 @@
+#ifndef __WorkStealingPool_h__
+#define __WorkStealingPool_h__
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+*	@brief Fixed-size pool of worker threads with one task deque per worker. Tasks
+*	are dealt round-robin to the workers in submission order; a worker runs tasks
+*	from the front of its own deque and, once it is empty, steals from the front
+*	of the fullest other deque. Submitting tasks largest first therefore keeps the
+*	largest remaining tasks running first on every worker.
+*	Each task carries a memory estimate; a task is started only while the sum of
+*	estimates of running tasks stays within the memory budget (a task larger than
+*	the budget runs alone).
+*/
+class WorkStealingPool
+{
+public:
+	typedef std::function<void()> Task;
+
+	WorkStealingPool(int, size_t);
+	virtual ~WorkStealingPool();
+
+	void submit(const Task &, size_t);
+	void run();
+
+	int getNumWorkers() const;
+
+private:
+	struct Job
+	{
+		Task task;
+		size_t mem;
+	};
+
+	void work(int);
+	bool nextJob(int, Job &);
+
+	void acquire(size_t);
+	void release(size_t);
+
+	int num_workers;
+	size_t memBudget; //0: unlimited
+	size_t memInUse;
+	int num_running;
+	size_t num_submitted;
+
+	std::vector<std::deque<Job>> queues;
+	std::vector<std::unique_ptr<std::mutex>> queueLocks;
+
+	std::mutex memLock;
+	std::condition_variable memFreed;
+};
+
+#endif __WorkStealingPool_h__